@@ -26,17 +26,20 @@
 #include <malloc.h>
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "esp8266/eagle_soc.h"
 #include "esp8266/gpio_struct.h"
 #include "rom/ets_sys.h"
 #include "driver/gpio.h"
 #include "task.h"
 
+#include "esp_attr.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "result_codes.h"
 #include "i2c.h"
 #include "timer_util.h"
+#include "perf_stats.h"
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  *  Following macro used to validate and assign context to ptr
@@ -59,8 +62,27 @@ ptr = (i2c_type_t *)context
  *  GPIO is defined in gpio_struct.h
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 #define GPIO_GET_LEVEL(x)       (GPIO.in >> (x)) & 0x1
-#define GPIO_SET_LEVEL_LOW(x)   GPIO.out_w1tc |= (0x1 << (x))
-#define GPIO_SET_LEVEL_HIGH(x)  GPIO.out_w1ts |= (0x1 << (x))
+#define GPIO_SET_LEVEL_LOW(x)   GPIO.out_w1tc = (0x1 << (x))     // w1tc/w1ts are write-only, 
+#define GPIO_SET_LEVEL_HIGH(x)  GPIO.out_w1ts = (0x1 << (x))     // reading them back is wasted work.
+#define GPIO_SET_MASK_LOW(m)    GPIO.out_w1tc = (m)              // every pin in m, e.g. all SDA lanes.
+#define GPIO_SET_MASK_HIGH(m)   GPIO.out_w1ts = (m)
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Selects the kernel used to clock out the 8 data bits of a byte.
+ *      1 - writeBitsUnrolled(): unrolled, IRAM resident, precomputed masks.
+ *      0 - writeBitsLoop(): original mask/shift loop.
+ *  Override from the Makefile with -DI2C_USE_UNROLLED_KERNEL=0.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef I2C_USE_UNROLLED_KERNEL
+#define I2C_USE_UNROLLED_KERNEL 1
+#endif
+
+#if I2C_USE_UNROLLED_KERNEL
+#define WRITE_BITS(ptr, byte)   writeBitsUnrolled(ptr, byte)
+#else
+#define WRITE_BITS(ptr, byte)   writeBitsLoop(ptr, byte)
+#endif
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -68,33 +90,126 @@ ptr = (i2c_type_t *)context
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 typedef enum _I2C_STATE { ACK, READY, START, STOP, WRITE } I2C_STATE;
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Delays, in cpu ticks, applied by a bus-speed profile. See TIMINGS.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef struct _i2c_timing_t {
+    uint32_t    hdSta;      // tHD;STA
+    uint32_t    suSto;      // tSU;STO
+    uint32_t    buf;        // tBUF
+    uint32_t    low;        // tLOW  - 0 selects the undelayed bit kernel.
+    uint32_t    high;       // tHIGH
+    uint32_t    ackValid;   // SCL HIGH time before a polled ACK is sampled.
+}i2c_timing_t;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private structure for a pair of SCL/SDA pins, shared by every device 
+ * context created on those pins. Owns the pin configuration, the ACK ISR 
+ * and the lock that keeps one transaction on the wire at a time.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef struct _i2c_bus_t {
+    struct _i2c_bus_t       *next;          // registry of buses, see BUSES.
+    gpio_num_t              scl;
+    gpio_num_t              sda;            // first SDA lane, the only one unless a lane bus.
+    uint32_t                sdaMask;        // GPIO register bits of every SDA lane.
+    uint32_t                refCount;       // number of device contexts on this bus.
+    bool                    configured;     // pins set up as outputs by first device.
+    bool                    pullUp;         // internal SDA pull-up enabled (I2C_ACK_POLLED).
+    bool                    isrInstalled;   // ReadAckISR installed on SDA (I2C_ACK_ISR).
+    SemaphoreHandle_t       lock;           // held from I2C_StartXmit() to I2C_StopXmit().
+    struct _i2c_type_t * volatile active;   // device owning current transaction, read by ISR.
+}i2c_bus_t;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Following typedef used to pickout correct version of byte-writer
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef RESULT (*WRITEFN)(struct _i2c_type_t *, const uint8_t);
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  * Private context pointer structure used to manage I2C communication. 
+ * One per slave device, lightweight - bus resources live in i2c_bus_t.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 typedef struct _i2c_type_t {   
     uint32_t                opaque;         // address of structure - safety check prior to free.
     uint8_t                 slaveAddress;   // only supports 7-bit addresses.
+    i2c_bus_t               *bus;           // shared pins, ISR and lock.
+    bool                    ownsBus;        // bus lock taken by I2C_StartXmit().
     gpio_num_t              scl;            // SCL pin - control line.
     gpio_num_t              sda;            // SDA pin - data line. 
-    bool                    useAck;         // if false, 9th SCL cycle not used for ACK result.
+    uint32_t                sclMask;        // precomputed GPIO register bit for scl.
+    uint32_t                sdaMask;        // precomputed GPIO register bits for sda, all lanes.
+    uint8_t                 laneCount;      // SDA lanes sharing scl, 1 for a regular bus.
+    uint32_t                laneMasks[I2C_MAX_LANES];   // GPIO register bit of each lane.
+    uint32_t                nackedMask;     // lanes that NACK'd since I2C_StartXmit().
+    I2C_ACK_MODE            ackMode;        // how the 9th SCL cycle captures the ACK result.
+    I2C_ACK_MODE            xmitAckMode;    // ackMode of the current transaction, see I2C_SetAckVerify().
+    WRITEFN                 writeFn;        // byte writer for xmitAckMode.
+    uint32_t                verifyEvery;    // I2C_ACK_NONE only: poll ACKs every Nth transaction, 0 never.
+    uint32_t                xmitCount;      // transactions since last verified one.
+    const i2c_timing_t      *timing;        // delays for the selected bus-speed profile.
     volatile I2C_STATE      state;          // state of I2C transmission. 
     volatile uint32_t       isrAckCount;    // captures how many times ISR processed an ACK result.
                                             // Only set by ISR. Read-only for tasks.
+    uint32_t                polledAckCount; // captures how many ACKs were read in I2C_ACK_POLLED mode.
+    uint32_t                nackCount;      // captures how many bytes were NACK'd by the slave.
+#if PERF_STATS_ENABLED
+    uint32_t                perfStart;      // cycle count at START, for bus-busy time.
+#endif
 }i2c_type_t;
 
+static const char *I2C_TAG = "I2C";
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *  Following typedef used to pickout correct version of byte-writer
+ *  Registry of buses in use, keyed by SCL/SDA pins. Only changed by 
+ *  acquireBus()/releaseBus() with the scheduler suspended.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
-typedef RESULT (*WRITEFN)(i2c_type_t *, const uint8_t);
-/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static i2c_bus_t *BUSES = NULL;
 
-static const char *I2C_TAG = "I2C";
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Bus-speed profiles, indexed by I2C_BUS_SPEED. Tick counts are computed at 
+ *  compile time from CPU_FREQ_MHZ, so running at 160MHz doubles the counts 
+ *  rather than halving the times.
+ *
+ *  Minimum bus time to clock out 1KB of GDDRAM data (1024 bytes x 9 clocks),
+ *  derived from tLOW+tHIGH. Code overhead and START/STOP come on top; the
+ *  measured full-frame times for this build are logged by app_main.
+ *  -----------------------------------------------------------------------------
+ *  PROFILE     tHD;STA  tSU;STO   tBUF   tLOW  tHIGH  ACK SAMPLE   1KB @ MIN
+ *  -----------------------------------------------------------------------------
+ *  STANDARD     4000ns   4000ns  4700ns 4700ns 4000ns    4000ns     80.2ms
+ *  FAST          600ns    600ns  1300ns 1300ns  600ns     600ns     17.5ms
+ *  FAST_PLUS     260ns    260ns   500ns  500ns  260ns     260ns      7.0ms
+ *  MAX           600ns    600ns  1300ns     0      0      100ns    cpu bound
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static const i2c_timing_t TIMINGS[] = {
+    [I2C_SPEED_STANDARD]  = { TICKS_IN_4000_NS, TICKS_IN_4000_NS, TICKS_IN_4700_NS, 
+                              TICKS_IN_4700_NS, TICKS_IN_4000_NS, TICKS_IN_4000_NS },
+    [I2C_SPEED_FAST]      = { TICKS_IN_600_NS,  TICKS_IN_600_NS,  TICKS_IN_1300_NS, 
+                              TICKS_IN_1300_NS, TICKS_IN_600_NS,  TICKS_IN_600_NS },
+    [I2C_SPEED_FAST_PLUS] = { NS_TO_TICKS(260), NS_TO_TICKS(260), TICKS_IN_500_NS, 
+                              TICKS_IN_500_NS,  NS_TO_TICKS(260), NS_TO_TICKS(260) },
+    [I2C_SPEED_MAX]       = { TICKS_IN_600_NS,  TICKS_IN_600_NS,  TICKS_IN_1300_NS, 
+                              0,                0,                TICKS_IN_100_NS }
+};
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  *  Forward reference private methods.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
-static RESULT enableACK(i2c_type_t *ptr);
+static RESULT acquireBus(const gpio_num_t scl, const gpio_num_t sda, const uint32_t sdaMask, 
+                         const I2C_ACK_MODE ackMode, i2c_bus_t **bus);
+static void releaseBus(i2c_bus_t *bus);
+static RESULT configureBus(i2c_bus_t *bus, const I2C_ACK_MODE ackMode);
+static RESULT enableACK(i2c_bus_t *bus);
 static RESULT writeByte(i2c_type_t *ptr, const uint8_t byte);
+static RESULT writeByteNoAck(i2c_type_t *ptr, const uint8_t byte);
+static void clockAckBlind(i2c_type_t *ptr);
+static RESULT readAck(i2c_type_t *ptr, const uint8_t byteSent);
+static uint32_t readAckPolled(i2c_type_t *ptr);
+static void writeBitsLanes(i2c_type_t *ptr, const uint32_t *setMasks);
+static void writeBitsLoop(i2c_type_t *ptr, const uint8_t byte);
+static void writeBitsUnrolled(i2c_type_t *ptr, const uint8_t byte);
+static void writeBitsTimed(i2c_type_t *ptr, const uint8_t byte);
 static RESULT setState(i2c_type_t *ptr, const I2C_STATE newState);
 static const char *stateToString(I2C_STATE state);
 #if 0 
@@ -105,14 +220,16 @@ static uint32_t calculateFallTime(const gpio_num_t pin);
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * The following ISR is used to capture ACK result from slave. ACKs occur when 
  * slave pulls SDA line LOW. This ISR is configured to trigger on a falling edge.
+ * One ISR per bus, the ACK is credited to the device owning the transaction.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 static void 
 ReadAckISR(void *context)
 {
-    i2c_type_t *ptr = (i2c_type_t *)context;
+    i2c_bus_t *bus = (i2c_bus_t *)context;
     uint32_t status = GPIO_REG_READ(GPIO_STATUS_ADDRESS);   // see gpio_register.h
     GPIO_REG_WRITE(GPIO_STATUS_W1TC_ADDRESS, status);       // clear interrupt flag
-    if (ptr->state == ACK) {
+    i2c_type_t *ptr = bus->active;
+    if ((ptr != NULL) && (ptr->state == ACK)) {
         ptr->state = WRITE;
         ptr->isrAckCount++;
     }
@@ -125,18 +242,52 @@ ReadAckISR(void *context)
  *      slaveAddress - device to communicate with. Address must not be left-shifted. 
  *               scl - SCL pin number.
  *               sda - SDA pin number.
- *            useAck - if true will call enableACK() to initialize ISR and set write method.
+ *           ackMode - I2C_ACK_ISR will call enableACK() to initialize ISR.
+ *                     I2C_ACK_POLLED reads SDA directly, no ISR is installed.
+ *             speed - bus-speed profile, see TIMINGS.
  *           context -  pointer to pointer to store context structure.
  *
  *  OUTPUT
  *      OK  success or failure code.
  *
+ *  NOTE
+ *      Contexts created on the same scl/sda pins share one bus: the pins are
+ *      configured and the ACK ISR installed once, by whichever context first 
+ *      needs them. Each context is one slave device with its own address,
+ *      ackMode and speed, and transactions from different contexts are 
+ *      serialized by the bus lock. A pin can only belong to one bus.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 RESULT 
-I2C_Initialize(const uint8_t slaveAddress, const gpio_num_t scl, const gpio_num_t sda, const bool useAck, void **context) 
+I2C_Initialize(const uint8_t slaveAddress, const gpio_num_t scl, const gpio_num_t sda, const I2C_ACK_MODE ackMode, 
+               const I2C_BUS_SPEED speed, void **context) 
+{
+    return I2C_InitializeLanes(slaveAddress, scl, &sda, 1, ackMode, speed, context);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method used to initialize a parallel lane context: laneCount slaves
+ * at the same address, sharing scl, each on its own sda pin.
+ *
+ *  INPUT
+ *               sda - array of laneCount SDA pin numbers.
+ *         laneCount - 1 to I2C_MAX_LANES.
+ *           ackMode - I2C_ACK_NONE or I2C_ACK_POLLED. The ISR can only watch 
+ *                     one pin, so I2C_ACK_ISR requires laneCount of 1.
+ *
+ *  NOTE
+ *      Every SDA register bit is set or cleared by the same store, so one 
+ *      clock sequence shifts a byte into every lane. Bytes written with the
+ *      regular API are sent to all lanes, I2C_WriteLanes() sends a different
+ *      byte to each lane. A polled ACK is sampled on all lanes at once and
+ *      any lane that NACKs fails the byte, see I2C_WriteLanes().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT 
+I2C_InitializeLanes(const uint8_t slaveAddress, const gpio_num_t scl, const gpio_num_t *sda, const uint8_t laneCount,
+                    const I2C_ACK_MODE ackMode, const I2C_BUS_SPEED speed, void **context) 
 {
     #ifdef DEBUG
-    ESP_LOGD(I2C_TAG, "I2C_Initialize(): Inputs slaveAddress: 0x%x, SCL:%d, SDA:%d.", slaveAddress, scl, sda);
+    ESP_LOGD(I2C_TAG, "I2C_Initialize(): Inputs slaveAddress: 0x%x, SCL:%d, SDA:%d, lanes:%d.", 
+                        slaveAddress, scl, (sda != NULL) ? (int)sda[0] : -1, laneCount);
     #endif
 
     if (context == NULL) {
@@ -144,14 +295,38 @@ I2C_Initialize(const uint8_t slaveAddress, const gpio_num_t scl, const gpio_num_
         return INVALID_CONTEXT;    
     }
 
+    if ((sda == NULL) || (laneCount == 0) || (laneCount > I2C_MAX_LANES)) {
+        ESP_LOGE(I2C_TAG, "I2C_Initialize(): Need 1 to %d SDA lanes, got %d.", I2C_MAX_LANES, laneCount);
+        return INVALID_ARGUMENT;
+    }
+
     if (!GPIO_IS_VALID_GPIO(scl)) {
         ESP_LOGE(I2C_TAG, "I2C_Initialize(): SCL Pin %d not valid GPIO PIN.", scl);
         return INVALID_SCL_PIN;   
     }
 
-    if (!GPIO_IS_VALID_GPIO(sda)) {
-        ESP_LOGE(I2C_TAG, "I2C_Initialize(): SDA Pin %d not valid GPIO PIN.", sda);
-        return INVALID_SDA_PIN;   
+    uint32_t sdaMask = 0;
+    for (uint8_t x=0; x<laneCount; x++) {
+        if (!GPIO_IS_VALID_GPIO(sda[x]) || (sda[x] == scl) || (sdaMask & (0x1 << sda[x]))) {
+            ESP_LOGE(I2C_TAG, "I2C_Initialize(): SDA Pin %d not valid GPIO PIN.", sda[x]);
+            return INVALID_SDA_PIN;   
+        }
+        sdaMask |= 0x1 << sda[x];
+    }
+
+    if ((ackMode == I2C_ACK_ISR) && (laneCount > 1)) {
+        ESP_LOGE(I2C_TAG, "I2C_Initialize(): I2C_ACK_ISR cannot watch %d SDA lanes.", laneCount);
+        return INVALID_ARGUMENT;
+    }
+
+    if ((ackMode != I2C_ACK_NONE) && (ackMode != I2C_ACK_ISR) && (ackMode != I2C_ACK_POLLED)) {
+        ESP_LOGE(I2C_TAG, "I2C_Initialize(): Unknown ackMode %d.", ackMode);
+        return INVALID_ARGUMENT;
+    }
+
+    if ((uint32_t)speed >= sizeof(TIMINGS)/sizeof(TIMINGS[0])) {
+        ESP_LOGE(I2C_TAG, "I2C_Initialize(): Unknown bus speed %d.", speed);
+        return INVALID_ARGUMENT;
     }
 
     uint8_t shiftedAddress = slaveAddress << 1;
@@ -184,44 +359,105 @@ I2C_Initialize(const uint8_t slaveAddress, const gpio_num_t scl, const gpio_num_
         return FAILED_TO_ALLOCATE_MEMORY;    
     }
 
-    gpio_config_t io_conf = {0};
-    io_conf.pin_bit_mask = (1ULL << scl) | (1ULL << sda);
-    io_conf.mode         = GPIO_MODE_OUTPUT; 
-    io_conf.pull_up_en   = GPIO_PULLUP_DISABLE; 
-    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    io_conf.intr_type    = GPIO_INTR_DISABLE;
-    esp_err_t esp_result = gpio_config(&io_conf);
-    if (esp_result != ESP_OK) {
-        ESP_LOGE(I2C_TAG, "I2C_Initialize(): Failed to configure pins SDA:%d, SCL:%d. ESP Error: %d", sda, scl, esp_result);
-        return FAILED_TO_CONFIGURE_I2C_PINS;
+    i2c_bus_t *bus = NULL;
+    RESULT result = acquireBus(scl, sda[0], sdaMask, ackMode, &bus);
+    if (result != OK) {
+        free(ptr);
+        return result;
     }
-    
-    // Setting pins to OUTPUT causes the pin levels to go LOW.
-    // Reset them both HIGH sda followed by scl so that we don't 
-    // trigger device logic.
-    GPIO_SET_LEVEL_HIGH(sda);
-    GPIO_SET_LEVEL_HIGH(scl);
-
-    #ifdef DEBUG
-    ESP_LOGD(I2C_TAG, "I2C_Initialize(): SCL:%d and SDA:%d pins configured successfully.", scl, sda);
-    #endif
 
     ptr->opaque       = (uint32_t)ptr;      // self-reference the pointer address
     ptr->slaveAddress = slaveAddress << 1;  // make room for r/w bit in lowest most significant digit
+    ptr->bus          = bus;
+    ptr->ownsBus      = false;
     ptr->scl          = scl;
-    ptr->sda          = sda;
+    ptr->sda          = sda[0];
+    ptr->sclMask      = 0x1 << scl;
+    ptr->sdaMask      = sdaMask;
+    ptr->laneCount    = laneCount;
+    ptr->nackedMask   = 0;
+    for (uint8_t x=0; x<laneCount; x++) {
+        ptr->laneMasks[x] = 0x1 << sda[x];
+    }
     ptr->state        = READY;
+    ptr->ackMode      = ackMode;
+    ptr->xmitAckMode  = ackMode;
+    ptr->writeFn      = (ackMode == I2C_ACK_NONE) ? writeByteNoAck : writeByte;
+    ptr->verifyEvery  = 0;
+    ptr->xmitCount    = 0;
+    ptr->timing       = &TIMINGS[speed];
     ptr->isrAckCount  = 0;
+    ptr->polledAckCount = 0;
+    ptr->nackCount    = 0;
+
+    *context = (void *)ptr;
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Public method to switch bus-speed profile. Bus must not be mid-transaction.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+I2C_SetBusSpeed(void *context, const I2C_BUS_SPEED speed)
+{
+    i2c_type_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "I2C_SetBusSpeed");
+
+    if ((uint32_t)speed >= sizeof(TIMINGS)/sizeof(TIMINGS[0])) {
+        ESP_LOGE(I2C_TAG, "I2C_SetBusSpeed(): Unknown bus speed %d.", speed);
+        return INVALID_ARGUMENT;
+    }
+
+    if (ptr->state != READY) {
+        ESP_LOGE(I2C_TAG, "I2C_SetBusSpeed(): Cannot change speed in state '%s'.", stateToString(ptr->state));
+        return INVALID_STATE_CHANGE_REQUEST;
+    }
 
-    if (useAck == true) {
-        RESULT result = enableACK(ptr);
+    ptr->timing = &TIMINGS[speed];
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Public method to periodically check the link of an I2C_ACK_NONE context.
+ *
+ *  INPUT
+ *      everyN  - every Nth transaction reads ACKs as in I2C_ACK_POLLED mode and 
+ *                fails with FAILED_WRITE_RECEIVED_NACK if the slave is gone. 
+ *                The others clock the 9th bit blind. 0 turns checking off.
+ *
+ *  NOTE
+ *      Enables the SDA pull-up on the bus, polled ACKs need it.
+ *      Bus must not be mid-transaction.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+I2C_SetAckVerify(void *context, const uint32_t everyN)
+{
+    i2c_type_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "I2C_SetAckVerify");
+
+    if (ptr->ackMode != I2C_ACK_NONE) {
+        ESP_LOGE(I2C_TAG, "I2C_SetAckVerify(): Context already reads ACKs, ackMode=%d.", ptr->ackMode);
+        return INVALID_ARGUMENT;
+    }
+
+    if (ptr->state != READY) {
+        ESP_LOGE(I2C_TAG, "I2C_SetAckVerify(): Cannot change verification in state '%s'.", stateToString(ptr->state));
+        return INVALID_STATE_CHANGE_REQUEST;
+    }
+
+    if (everyN != 0) {
+        xSemaphoreTakeRecursive(ptr->bus->lock, portMAX_DELAY);
+        RESULT result = configureBus(ptr->bus, I2C_ACK_POLLED);
+        xSemaphoreGiveRecursive(ptr->bus->lock);
         if (result != OK) {
-            I2C_FreeContext((void **)&ptr);
             return result;
         }
-    } 
+    }
 
-    *context = (void *)ptr;
+    ptr->verifyEvery = everyN;
+    ptr->xmitCount   = 0;
+    ptr->xmitAckMode = I2C_ACK_NONE;
+    ptr->writeFn     = writeByteNoAck;
     return OK;
 }
 
@@ -242,6 +478,14 @@ RESULT I2C_FreeContext(void **context)
         return INVALID_CONTEXT;
     }
 
+    if (ptr->ownsBus) {
+        ESP_LOGE(I2C_TAG, "FreeContext(): Context freed mid-transaction, releasing bus.");
+        ptr->bus->active = NULL;
+        xSemaphoreGiveRecursive(ptr->bus->lock);
+    }
+
+    releaseBus(ptr->bus);
+    ptr->opaque = 0;
     free(ptr);
     *context = NULL;
     return OK;
@@ -254,6 +498,8 @@ RESULT I2C_FreeContext(void **context)
  *      Must be called prior to any transmission. 
  *      Input state: READY. 
  *      Output state: START.
+ *      Blocks while another device on the same bus is mid-transaction. The
+ *      bus stays locked until I2C_StopXmit(), even if this call fails.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 RESULT
 I2C_StartXmit(void *context) 
@@ -266,18 +512,34 @@ I2C_StartXmit(void *context)
         ESP_LOGE(I2C_TAG, "I2C_StartXmit(): Failed to change state to START. Error = %d.", result);
         return result;
     }
+
+    xSemaphoreTakeRecursive(ptr->bus->lock, portMAX_DELAY);
+    ptr->ownsBus     = true;
+    ptr->bus->active = ptr;
+    ptr->nackedMask  = 0;
+    PERF_BUS_START(ptr->perfStart);
+
+    if (ptr->verifyEvery != 0) {
+        bool verify = (++ptr->xmitCount >= ptr->verifyEvery);
+        if (verify) {
+            ptr->xmitCount = 0;
+        }
+        ptr->xmitAckMode = verify ? I2C_ACK_POLLED : I2C_ACK_NONE;
+        ptr->writeFn     = verify ? writeByte : writeByteNoAck;
+    }
  
-    GPIO_SET_LEVEL_LOW(ptr->sda);      
-    delay(TICKS_IN_600_NS);                         // tHD;STA                         
+    GPIO_SET_MASK_LOW(ptr->sdaMask);      
+    delay(ptr->timing->hdSta);                      // tHD;STA                         
     GPIO_SET_LEVEL_LOW(ptr->scl);
 
     uint8_t address = ptr->slaveAddress & 0xFE;     // turn off lsb to signal write op
-    result = writeByte(ptr, address);
+    result = ptr->writeFn(ptr, address);
     if (result != OK) {
         ESP_LOGE(I2C_TAG, "I2C_StartXmit(): Failed to write address byte (0x%x) to slave. Error=%d", address, result);
+        return result;
     }
 
-    return result;   
+    return setState(ptr, WRITE);                    // no-op unless the ACK was not read   
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -294,6 +556,10 @@ I2C_StopXmit(void *context)
     i2c_type_t *ptr;
     ASSIGN_CONTEXT(ptr, context, "I2C_Stop");
 
+    if (ptr->state == WRITE) {
+        setState(ptr, STOP);                        // STOP requested right after a NACK'd byte.
+    }
+
     RESULT result = setState(ptr, READY);           
     if (result != OK) {
         ESP_LOGE(I2C_TAG, "I2C_StopXmit(): failed to change state to READY. Error = %d.", result);
@@ -301,9 +567,16 @@ I2C_StopXmit(void *context)
     }
 
     GPIO_SET_LEVEL_HIGH(ptr->scl);       
-    delay(TICKS_IN_600_NS);                         // tSU;STO
-    GPIO_SET_LEVEL_HIGH(ptr->sda);       
-    delay(TICKS_IN_1300_NS);                        // tBUF
+    delay(ptr->timing->suSto);                      // tSU;STO
+    GPIO_SET_MASK_HIGH(ptr->sdaMask);       
+    delay(ptr->timing->buf);                        // tBUF
+
+    if (ptr->ownsBus) {
+        PERF_BUS_STOP(ptr->perfStart);
+        ptr->ownsBus     = false;
+        ptr->bus->active = NULL;
+        xSemaphoreGiveRecursive(ptr->bus->lock);
+    }
     return OK;
 }
 
@@ -362,7 +635,7 @@ I2C_Write(void *context, const uint8_t byte)
         return result;
     }
 
-    result = writeByte(ptr, byte); 
+    result = ptr->writeFn(ptr, byte); 
     if (result != OK) {
         ESP_LOGE(I2C_TAG, "I2C_Write(): Failed to write byte 0x%x. Error=%d", byte, result);
     }
@@ -371,9 +644,221 @@ I2C_Write(void *context, const uint8_t byte)
     return result;
 }
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Public method to write a contiguous buffer to slave device in one burst.
+ *
+ *  INPUT
+ *      buffer      - bytes to send.
+ *      length      - number of bytes in buffer.
+ *      nackOffset  - optional. Receives offset of the first byte NACK'd by the
+ *                    slave, or length if every byte was ACK'd.
+ *
+ *  NOTE
+ *      See I2C_WriteBuffers().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+I2C_WriteBuffer(void *context, const uint8_t *buffer, const size_t length, size_t *nackOffset)
+{
+    const I2C_BUFFER single = { buffer, length };
+    return I2C_WriteBuffers(context, &single, 1, nackOffset);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Public method to write a list of buffers to slave device in one burst.
+ *
+ *  The context and state are validated once for the whole burst rather than
+ *  once per byte as I2C_Write() does. Transmission stops at the first NACK.
+ *
+ *  INPUT
+ *      buffers     - array of scatter/gather elements, sent in order.
+ *      count       - number of elements in buffers.
+ *      nackOffset  - optional. Receives offset (counted across all buffers) of
+ *                    the first byte NACK'd by the slave, or the total number
+ *                    of bytes if every byte was ACK'd.
+ *
+ *  NOTE
+ *      Input state: START, WRITE or STOP.
+ *      Output state: STOP.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+I2C_WriteBuffers(void *context, const I2C_BUFFER *buffers, const size_t count, size_t *nackOffset)
+{
+    i2c_type_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "I2C_WriteBuffers");
+
+    if ((buffers == NULL) && (count > 0)) {
+        ESP_LOGE(I2C_TAG, "I2C_WriteBuffers(): buffers cannot be NULL.");
+        return INVALID_ARGUMENT;
+    }
+
+    for (size_t x=0; x<count; x++) {
+        if ((buffers[x].data == NULL) && (buffers[x].length > 0)) {
+            ESP_LOGE(I2C_TAG, "I2C_WriteBuffers(): buffers[%u].data cannot be NULL.", (unsigned)x);
+            return INVALID_ARGUMENT;
+        }
+    }
+
+    RESULT result = setState(ptr, WRITE);
+    if (result != OK) {
+        ESP_LOGE(I2C_TAG, "I2C_WriteBuffers(): Failed to change state to WRITE. Error = %d.", result);
+        return result;
+    }
+
+    size_t offset = 0;
+    for (size_t x=0; (x<count) && (result == OK); x++) {
+        const uint8_t *data = buffers[x].data;
+        const uint8_t *end  = data + buffers[x].length;
+        while (data < end) {
+            result = ptr->writeFn(ptr, *data);
+            if (result != OK) {
+                ESP_LOGE(I2C_TAG, "I2C_WriteBuffers(): Failed to write byte 0x%x at offset %u. Error=%d",
+                                    *data, (unsigned)offset, result);
+                break;
+            }
+            data++;
+            offset++;
+        }
+    }
+
+    if (nackOffset != NULL) {
+        *nackOffset = offset;
+    }
+
+    setState(ptr, STOP);        // signal that bytes were sent and STOP is possible.
+    return result;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Public method to write a different buffer to each lane of a lane context
+ *  in one burst. Byte x of every lane is clocked out by the same SCL pulses.
+ *
+ *  INPUT
+ *      lanes       - one buffer per lane, laneCount entries, each length bytes.
+ *      length      - number of bytes sent on each lane.
+ *      nackLanes   - optional. Receives a bit per lane (bit 0 = lane 0) set
+ *                    for every lane that NACK'd in this transaction, 
+ *                    including the address byte and broadcast writes.
+ *
+ *  NOTE
+ *      Input state: START, WRITE or STOP.
+ *      Output state: STOP.
+ *      Transmission stops at the first byte NACK'd by any lane. With 
+ *      I2C_ACK_NONE lanes are never reported.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+I2C_WriteLanes(void *context, const uint8_t *const *lanes, const size_t length, uint32_t *nackLanes)
+{
+    i2c_type_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "I2C_WriteLanes");
+
+    if (lanes == NULL) {
+        ESP_LOGE(I2C_TAG, "I2C_WriteLanes(): lanes cannot be NULL.");
+        return INVALID_ARGUMENT;
+    }
+
+    for (uint8_t x=0; x<ptr->laneCount; x++) {
+        if ((lanes[x] == NULL) && (length > 0)) {
+            ESP_LOGE(I2C_TAG, "I2C_WriteLanes(): lanes[%d] cannot be NULL.", x);
+            return INVALID_ARGUMENT;
+        }
+    }
+
+    RESULT result = setState(ptr, WRITE);
+    if (result != OK) {
+        ESP_LOGE(I2C_TAG, "I2C_WriteLanes(): Failed to change state to WRITE. Error = %d.", result);
+        return result;
+    }
+
+    for (size_t offset=0; (offset<length) && (result == OK); offset++) {
+        uint32_t setMasks[8] = {0};                 // lanes whose bit is 1, indexed by bit
+        for (uint8_t x=0; x<ptr->laneCount; x++) {
+            const uint8_t  byte = lanes[x][offset];
+            const uint32_t mask = ptr->laneMasks[x];
+            for (uint8_t bit=0; bit<8; bit++) {
+                if ((byte >> bit) & 0x1) {
+                    setMasks[bit] |= mask;
+                }
+            }
+        }
+
+        writeBitsLanes(ptr, setMasks);
+        result = readAck(ptr, lanes[0][offset]);
+        if (result != OK) {
+            ESP_LOGE(I2C_TAG, "I2C_WriteLanes(): Failed to write lanes at offset %u. Error=%d", (unsigned)offset, result);
+        }
+    }
+
+    if (nackLanes != NULL) {
+        *nackLanes = 0;
+        for (uint8_t x=0; x<ptr->laneCount; x++) {
+            if (ptr->nackedMask & ptr->laneMasks[x]) {
+                *nackLanes |= 0x1 << x;
+            }
+        }
+    }
+
+    setState(ptr, STOP);        // signal that bytes were sent and STOP is possible.
+    return result;
+}
+
+#ifdef DEBUG
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Public method to measure the throughput of both bit kernels with CCOUNT.
+ *
+ *  INPUT
+ *      byteCount   number of bytes each kernel clocks out.
+ *
+ *  NOTES
+ *      Bus must be idle (READY). SCL is pulled LOW while SDA is HIGH and SDA
+ *      only changes while SCL is LOW, so no START condition is generated 
+ *      and slaves ignore the clock pulses. ACK clocks are not included.
+ *      Results are logged as cpu ticks per byte and bytes per second.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+I2C_BenchmarkKernels(void *context, const uint32_t byteCount)
+{
+    i2c_type_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "I2C_BenchmarkKernels");
+
+    if ((ptr->state != READY) || (byteCount == 0)) {
+        ESP_LOGE(I2C_TAG, "I2C_BenchmarkKernels(): Bus must be READY and byteCount > 0. state='%s'.", 
+                            stateToString(ptr->state));
+        return INVALID_ARGUMENT;
+    }
+
+    static const struct {
+        const char  *name;
+        void        (*kernel)(i2c_type_t *, const uint8_t);
+    } kernels[] = {
+        { "loop",       writeBitsLoop },
+        { "unrolled",   writeBitsUnrolled }
+    };
+
+    xSemaphoreTakeRecursive(ptr->bus->lock, portMAX_DELAY);
+    GPIO_SET_LEVEL_LOW(ptr->scl);
+
+    for (size_t k=0; k<sizeof(kernels)/sizeof(kernels[0]); k++) {
+        uint32_t start = getCCOUNT();
+        for (uint32_t x=0; x<byteCount; x++) {
+            kernels[k].kernel(ptr, (uint8_t)x);
+        }
+        uint32_t ticks = getCCOUNT() - start;
+
+        ESP_LOGI(I2C_TAG, "I2C_BenchmarkKernels(): %s kernel: %u bytes in %u ticks, %u ticks/byte, %u bytes/s.",
+                            kernels[k].name, byteCount, ticks, ticks/byteCount,
+                            (uint32_t)(((uint64_t)byteCount * CPU_FREQ_MHZ * 1000000) / ticks));
+    }
+
+    GPIO_SET_MASK_HIGH(ptr->sdaMask);
+    GPIO_SET_LEVEL_HIGH(ptr->scl);
+    xSemaphoreGiveRecursive(ptr->bus->lock);
+    return OK;
+}
+#endif
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Private method used to Write a single byte to wire and captures ACK result from slave.
- * Must keep interface consistent with writeByteNoAck() method.
+ * Must keep interface consistent with writeByteNoAck() method, see WRITEFN.
  *
  *  INPUTS
  *      ptr         Points to i2c context
@@ -393,21 +878,87 @@ I2C_Write(void *context, const uint8_t byte)
 static RESULT
 writeByte(i2c_type_t *ptr, const uint8_t byteToSend) 
 {
-    uint16_t bitMask = 0x0100; 
-    uint8_t bitToSend;
+    if (ptr->timing->low == 0) {
+        WRITE_BITS(ptr, byteToSend);
+    } else {
+        writeBitsTimed(ptr, byteToSend);
+    }
 
-    while (bitMask != 0x1) {
-        bitMask >>= 1;
-        bitToSend = byteToSend & bitMask;
+    return readAck(ptr, byteToSend);
+}
 
-        if (bitToSend>0) {
-            GPIO_SET_LEVEL_HIGH(ptr->sda);      
-        } else {
-            GPIO_SET_LEVEL_LOW(ptr->sda);    
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Private method used to Write a single byte to wire without reading the ACK.
+ * Byte writer for I2C_ACK_NONE transactions, see WRITEFN.
+ *
+ *  OUTPUT
+ *      OK          Always. State is left alone, no ISR or settle delay involved.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+writeByteNoAck(i2c_type_t *ptr, const uint8_t byteToSend) 
+{
+    if (ptr->timing->low == 0) {
+        WRITE_BITS(ptr, byteToSend);
+    } else {
+        writeBitsTimed(ptr, byteToSend);
+    }
+
+    clockAckBlind(ptr);
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method used to clock the 9th (ACK) bit without sampling it.
+ *
+ *  NOTES
+ *      scl must come in LOW and exits LOW, sda exits driven LOW.
+ *      SDA is driven LOW rather than released: an ACKing slave pulls it LOW
+ *      too, so nothing fights over the line, and it is stable while SCL is 
+ *      HIGH so no START/STOP is seen.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void IRAM_ATTR
+clockAckBlind(i2c_type_t *ptr)
+{
+    PERF_COUNT_BYTES(1);
+    GPIO.out_w1tc = ptr->sdaMask;
+    if (ptr->timing->low) {
+        delay(ptr->timing->low);                // tLOW
+    }
+    GPIO.out_w1ts = ptr->sclMask;
+    if (ptr->timing->high) {
+        delay(ptr->timing->high);               // tHIGH
+    }
+    GPIO.out_w1tc = ptr->sclMask;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Private method used to clock the 9th (ACK) bit after the 8 data bits of byteSent.
+ * See writeByte() for the ACK capture notes.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+readAck(i2c_type_t *ptr, const uint8_t byteToSend)
+{
+    if (ptr->xmitAckMode == I2C_ACK_NONE) {
+        clockAckBlind(ptr);
+        return OK;
+    }
+
+    PERF_COUNT_BYTES(1);                        // every ACK'd byte, address and data, ends up here
+
+    if (ptr->xmitAckMode == I2C_ACK_POLLED) {
+        uint32_t nacked = readAckPolled(ptr);
+        if (nacked == 0) {
+            ptr->polledAckCount++;
+            return setState(ptr, WRITE);
         }
 
-        GPIO_SET_LEVEL_HIGH(ptr->scl);          // allow data capture by slave
-        GPIO_SET_LEVEL_LOW(ptr->scl);           // finish capture
+        setState(ptr, WRITE);
+        ptr->nackedMask |= nacked;
+        ptr->nackCount++;
+        PERF_COUNT_NACK();
+        ESP_LOGE(I2C_TAG, "writeByte(): Received NACK. Failed to write 0x%x to slave. polledAckCount=%d, nackCount=%d.", 
+                            byteToSend, ptr->polledAckCount, ptr->nackCount);
+        return FAILED_WRITE_RECEIVED_NACK;
     }
 
     // NOTE: Slaves will grab the sda line immediately after the 8th bit is set.
@@ -417,17 +968,25 @@ writeByte(i2c_type_t *ptr, const uint8_t byteToSend)
     //       the line will not actually go HIGH, and this will be visible in logic
     //       analyzer or oscilloscope.
     setState(ptr, ACK);                         // Allow ISR to capture ACK result 
-    GPIO_SET_LEVEL_HIGH(ptr->sda);              // Release sda line. For ACK, line will most likely already be LOW
+    GPIO_SET_MASK_HIGH(ptr->sdaMask);       // Release sda line. For ACK, line will most likely already be LOW
+    if (ptr->timing->low) {
+        delay(ptr->timing->low);                // tLOW
+    }
     GPIO_SET_LEVEL_HIGH(ptr->scl);              // ACK is not sent until SCL line high 
+    if (ptr->timing->high) {
+        delay(ptr->timing->high);               // tHIGH
+    }
     GPIO_SET_LEVEL_LOW(ptr->scl);               // finish capture, slave will now release sda line 
-    GPIO_SET_LEVEL_LOW(ptr->sda);
+    GPIO_SET_MASK_LOW(ptr->sdaMask);
     delay(TICKS_IN_100_NS);                     // a small delay is required to give time for ISR to process ACK
 
     if (ptr->state == ACK) {
         setState(ptr, WRITE);                   // ERROR: return error condition but leave it up to caller whether 
                                                 // to continue sending bytes.  
-        ESP_LOGE(I2C_TAG, "writeByte(): Received NACK. Failed to write 0x%x to slave. isrAckCount=%d.", 
-                            byteToSend, ptr->isrAckCount);
+        ptr->nackCount++;
+        PERF_COUNT_NACK();
+        ESP_LOGE(I2C_TAG, "writeByte(): Received NACK. Failed to write 0x%x to slave. isrAckCount=%d, nackCount=%d.", 
+                            byteToSend, ptr->isrAckCount, ptr->nackCount);
         return FAILED_WRITE_RECEIVED_NACK;
     }
 
@@ -435,10 +994,327 @@ writeByte(i2c_type_t *ptr, const uint8_t byteToSend)
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *  Private method called by initialize to enable ACK functionality.
+ * Private method used to clock the 9th (ACK) bit and sample SDA directly.
+ * Used when ackMode is I2C_ACK_POLLED.
+ *
+ *  OUTPUT
+ *      0 if every slave held SDA LOW (ACK), otherwise the sdaMask bits of the
+ *      lanes left HIGH (NACK).
+ *
+ *  NOTES
+ *      scl must come in LOW and exits LOW, sda exits driven LOW.
+ *      The SDA output driver is switched off rather than driven HIGH, so the
+ *      slave owns the line for the whole ACK cycle and the internal pull-up
+ *      brings it HIGH on a NACK. The sample is taken while SCL is HIGH, after
+ *      the profile's ackValid time to let a NACK'd line rise.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static uint32_t IRAM_ATTR
+readAckPolled(i2c_type_t *ptr)
+{
+    GPIO.enable_w1tc = ptr->sdaMask;            // release sda, switches pin to input
+    if (ptr->timing->low) {
+        delay(ptr->timing->low);                // tLOW
+    }
+    GPIO.out_w1ts    = ptr->sclMask;            // ACK is not sent until SCL line high
+    delay(ptr->timing->ackValid);
+    uint32_t level   = GPIO.in & ptr->sdaMask;
+    GPIO.out_w1tc    = ptr->sclMask;            // finish capture, slave will now release sda line
+    GPIO.out_w1tc    = ptr->sdaMask;            // output latch LOW before driver comes back on
+    GPIO.enable_w1ts = ptr->sdaMask;
+    return level;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method used to clock out the 8 data bits of a byte, MSB first.
+ * Original loop-based kernel, see I2C_USE_UNROLLED_KERNEL.
+ *
+ *  NOTES
+ *      scl must come in LOW and exits LOW.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+writeBitsLoop(i2c_type_t *ptr, const uint8_t byteToSend) 
+{
+    uint16_t bitMask = 0x0100; 
+    uint8_t bitToSend;
+
+    while (bitMask != 0x1) {
+        bitMask >>= 1;
+        bitToSend = byteToSend & bitMask;
+
+        if (bitToSend>0) {
+            GPIO_SET_MASK_HIGH(ptr->sdaMask);      
+        } else {
+            GPIO_SET_MASK_LOW(ptr->sdaMask);    
+        }
+
+        GPIO_SET_LEVEL_HIGH(ptr->scl);          // allow data capture by slave
+        GPIO_SET_LEVEL_LOW(ptr->scl);           // finish capture
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method used to clock out the 8 data bits of a byte, MSB first.
+ * Unrolled kernel, see I2C_USE_UNROLLED_KERNEL.
+ *
+ *  NOTES
+ *      scl must come in LOW and exits LOW.
+ *      Runs from IRAM so flash cache misses can't stretch the clock.
+ *      Each bit is three plain stores: the data bit picks w1ts or w1tc 
+ *      (no branch) for the sda mask, then scl goes HIGH and LOW.
+ *      SDA and SCL are never changed by the same store. SDA may only move
+ *      while SCL is LOW, and changing it on the same edge as SCL would look 
+ *      like a START or STOP condition to the slave.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#define SEND_BIT(byte, bit)                                                 \
+    *sdaReg[((byte) >> (bit)) & 0x1] = sda;                                 \
+    GPIO.out_w1ts = scl;                                                    \
+    GPIO.out_w1tc = scl
+
+static void IRAM_ATTR
+writeBitsUnrolled(i2c_type_t *ptr, const uint8_t byteToSend)
+{
+    volatile uint32_t *const sdaReg[2] = { &GPIO.out_w1tc, &GPIO.out_w1ts };
+    const uint32_t sda = ptr->sdaMask;
+    const uint32_t scl = ptr->sclMask;
+
+    SEND_BIT(byteToSend, 7);
+    SEND_BIT(byteToSend, 6);
+    SEND_BIT(byteToSend, 5);
+    SEND_BIT(byteToSend, 4);
+    SEND_BIT(byteToSend, 3);
+    SEND_BIT(byteToSend, 2);
+    SEND_BIT(byteToSend, 1);
+    SEND_BIT(byteToSend, 0);
+}
+#undef SEND_BIT
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method used to clock out one byte per lane, MSB first.
+ *
+ *  INPUT
+ *      setMasks    sdaMask bits of the lanes whose byte has a 1, indexed by bit.
+ *
+ *  NOTES
+ *      scl must come in LOW and exits LOW.
+ *      Lanes going HIGH and lanes going LOW take one store each, both while 
+ *      SCL is LOW. Honours tLOW/tHIGH like writeBitsTimed() when set.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void IRAM_ATTR
+writeBitsLanes(i2c_type_t *ptr, const uint32_t *setMasks)
+{
+    const uint32_t sda        = ptr->sdaMask;
+    const uint32_t scl        = ptr->sclMask;
+    const uint32_t holdTicks  = ptr->timing->low / 2;
+    const uint32_t setupTicks = ptr->timing->low - holdTicks;
+    const uint32_t highTicks  = ptr->timing->high;
+
+    for (int bit=7; bit>=0; bit--) {
+        if (holdTicks) {
+            delay(holdTicks);                   // tHD;DAT
+        }
+        GPIO.out_w1ts = setMasks[bit];
+        GPIO.out_w1tc = sda & ~setMasks[bit];
+        if (setupTicks) {
+            delay(setupTicks);                  // tSU;DAT
+        }
+        GPIO.out_w1ts = scl;
+        if (highTicks) {
+            delay(highTicks);                   // tHIGH
+        }
+        GPIO.out_w1tc = scl;
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method used to clock out the 8 data bits of a byte, MSB first.
+ * Used by bus-speed profiles with non-zero tLOW/tHIGH. tLOW is split around
+ * the SDA change to honour tHD;DAT and tSU;DAT.
+ *
+ *  NOTES
+ *      scl must come in LOW and exits LOW.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+writeBitsTimed(i2c_type_t *ptr, const uint8_t byteToSend)
+{
+    const uint32_t holdTicks  = ptr->timing->low / 2;
+    const uint32_t setupTicks = ptr->timing->low - holdTicks;
+
+    for (int bit=7; bit>=0; bit--) {
+        delay(holdTicks);                       // tHD;DAT
+        if ((byteToSend >> bit) & 0x1) {
+            GPIO.out_w1ts = ptr->sdaMask;
+        } else {
+            GPIO.out_w1tc = ptr->sdaMask;
+        }
+        delay(setupTicks);                      // tSU;DAT
+        GPIO.out_w1ts = ptr->sclMask;
+        delay(ptr->timing->high);               // tHIGH
+        GPIO.out_w1tc = ptr->sclMask;
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Private method to find the bus on scl/sdaMask, or create it, and configure 
+ *  it for ackMode. Buses must not share pins, unless they're the same bus.
+ *
+ *  OUTPUT
+ *      bus - referenced bus, release with releaseBus().
+ *
+ *  NOTE
+ *      The registry is searched and updated with the scheduler suspended, 
+ *      so concurrent initializers can't create the same bus twice. Pin setup
+ *      happens afterwards under the bus lock, since gpio_config() logs.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+acquireBus(const gpio_num_t scl, const gpio_num_t sda, const uint32_t sdaMask, 
+           const I2C_ACK_MODE ackMode, i2c_bus_t **bus)
+{
+    i2c_bus_t *ptr, *created = NULL;
+    gpio_num_t usedScl = 0, usedSda = 0;
+    const uint32_t sclMask = 0x1 << scl;
+
+    i2c_bus_t *spare = (i2c_bus_t *)calloc(1, sizeof(i2c_bus_t));
+    if (spare != NULL) {
+        spare->lock = xSemaphoreCreateRecursiveMutex();
+    }
+    if ((spare == NULL) || (spare->lock == NULL)) {
+        ESP_LOGE(I2C_TAG, "acquireBus(): Failed to allocate memory for bus!");
+        free(spare);
+        return FAILED_TO_ALLOCATE_MEMORY;
+    }
+
+    vTaskSuspendAll();
+    for (ptr = BUSES; ptr != NULL; ptr = ptr->next) {
+        if (((0x1 << ptr->scl) | ptr->sdaMask) & (sclMask | sdaMask)) {
+            break;
+        }
+    }
+
+    if (ptr == NULL) {
+        spare->scl     = scl;
+        spare->sda     = sda;
+        spare->sdaMask = sdaMask;
+        spare->next    = BUSES;
+        BUSES = spare;
+        ptr = created = spare;
+    }
+
+    if ((ptr->scl == scl) && (ptr->sdaMask == sdaMask)) {
+        ptr->refCount++;
+    } else {
+        usedScl = ptr->scl;
+        usedSda = ptr->sda;
+        ptr = NULL;
+    }
+    xTaskResumeAll();
+
+    if (created == NULL) {
+        vSemaphoreDelete(spare->lock);
+        free(spare);
+    }
+
+    if (ptr == NULL) {
+        ESP_LOGE(I2C_TAG, "acquireBus(): Pins SCL:%d, SDA:%d conflict with bus SCL:%d, SDA:%d.", 
+                            scl, sda, usedScl, usedSda);
+        return (((0x1 << usedScl) | (0x1 << usedSda)) & sclMask) ? INVALID_SCL_PIN : INVALID_SDA_PIN;
+    }
+
+    xSemaphoreTakeRecursive(ptr->lock, portMAX_DELAY);
+    RESULT result = configureBus(ptr, ackMode);
+    xSemaphoreGiveRecursive(ptr->lock);
+
+    if (result != OK) {
+        releaseBus(ptr);
+        return result;
+    }
+
+    *bus = ptr;
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Private method to drop a reference to a bus, tearing it down with the last one.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+releaseBus(i2c_bus_t *bus)
+{
+    vTaskSuspendAll();
+    bool last = (--bus->refCount == 0);
+    if (last) {
+        i2c_bus_t **link = &BUSES;
+        while (*link != bus) {
+            link = &(*link)->next;
+        }
+        *link = bus->next;
+
+    }
+    xTaskResumeAll();
+
+    if (last) {
+        if (bus->isrInstalled) {
+            gpio_isr_handler_remove(bus->sda);
+        }
+        vSemaphoreDelete(bus->lock);
+        free(bus);
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Private method to configure the bus pins for a new device. The first device
+ *  sets the pins up as outputs, later ones only add what their ackMode needs
+ *  (SDA pull-up for I2C_ACK_POLLED, the ISR for I2C_ACK_ISR). Bus lock held.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+configureBus(i2c_bus_t *bus, const I2C_ACK_MODE ackMode)
+{
+    if (!bus->configured) {
+        gpio_config_t io_conf = {0};
+        io_conf.pin_bit_mask = (1ULL << bus->scl) | bus->sdaMask;
+        io_conf.mode         = GPIO_MODE_OUTPUT; 
+        io_conf.pull_up_en   = (ackMode == I2C_ACK_POLLED) ? GPIO_PULLUP_ENABLE   // SDA floats while released for ACK
+                                                           : GPIO_PULLUP_DISABLE; 
+        io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+        io_conf.intr_type    = GPIO_INTR_DISABLE;
+        esp_err_t esp_result = gpio_config(&io_conf);
+        if (esp_result != ESP_OK) {
+            ESP_LOGE(I2C_TAG, "configureBus(): Failed to configure pins SDA:%d, SCL:%d. ESP Error: %d", 
+                                bus->sda, bus->scl, esp_result);
+            return FAILED_TO_CONFIGURE_I2C_PINS;
+        }
+        bus->pullUp     = (ackMode == I2C_ACK_POLLED);
+        bus->configured = true;
+
+        // Setting pins to OUTPUT causes the pin levels to go LOW.
+        // Reset them both HIGH sda followed by scl so that we don't 
+        // trigger device logic.
+        GPIO_SET_MASK_HIGH(bus->sdaMask);
+        GPIO_SET_LEVEL_HIGH(bus->scl);
+
+        #ifdef DEBUG
+        ESP_LOGD(I2C_TAG, "configureBus(): SCL:%d and SDA:%d pins configured successfully.", bus->scl, bus->sda);
+        #endif
+    } else if ((ackMode == I2C_ACK_POLLED) && !bus->pullUp) {
+        for (gpio_num_t pin=0; pin<GPIO_PIN_COUNT; pin++) {
+            if ((bus->sdaMask & (0x1 << pin)) && (gpio_pullup_en(pin) != ESP_OK)) {
+                ESP_LOGE(I2C_TAG, "configureBus(): Failed to enable pull-up on SDA:%d.", pin);
+                return FAILED_TO_CONFIGURE_I2C_PINS;
+            }
+        }
+        bus->pullUp = true;
+    }
+
+    if ((ackMode == I2C_ACK_ISR) && !bus->isrInstalled) {
+        return enableACK(bus);
+    }
+
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Private method called by configureBus to enable ACK functionality.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 static RESULT
-enableACK(i2c_type_t *ptr) 
+enableACK(i2c_bus_t *bus) 
 {
     // configure ISR service to use per-gpio handlers
     esp_err_t result = gpio_install_isr_service(0);
@@ -461,14 +1337,14 @@ enableACK(i2c_type_t *ptr)
     };
 
     // Configure the gpio pin to trigger when SDA line is LOW which signals ACK response.
-    result = gpio_set_intr_type(ptr->sda, GPIO_INTR_NEGEDGE);
+    result = gpio_set_intr_type(bus->sda, GPIO_INTR_NEGEDGE);
     if (result != ESP_OK) { 
-        ESP_LOGE(I2C_TAG, "enableACK(): Failed to set interrupt type. Invalid SDA pin (%d) likely culprit. Error = %d.", ptr->sda, result);
+        ESP_LOGE(I2C_TAG, "enableACK(): Failed to set interrupt type. Invalid SDA pin (%d) likely culprit. Error = %d.", bus->sda, result);
         return FAILED_TO_SET_INTERRUPT_TYPE;
     }
  
     // install the ISR
-    result = gpio_isr_handler_add(ptr->sda, ReadAckISR, (void *)ptr);
+    result = gpio_isr_handler_add(bus->sda, ReadAckISR, (void *)bus);
     switch (result) {
         case ESP_OK:
             break;
@@ -479,14 +1355,14 @@ enableACK(i2c_type_t *ptr)
             ESP_LOGE(I2C_TAG, "enableACK(): Failed to install ISR, must install ISR Service first. Error=%d.", result); 
             return FAILED_TO_INSTALL_ISR_FUNCTION;
         case ESP_ERR_INVALID_ARG:
-            ESP_LOGE(I2C_TAG, "enableACK(): Failed to install ISR, Invalid SDA pin (%d) likely culprit. Error=%d.", ptr->sda, result);
+            ESP_LOGE(I2C_TAG, "enableACK(): Failed to install ISR, Invalid SDA pin (%d) likely culprit. Error=%d.", bus->sda, result);
             return FAILED_TO_INSTALL_ISR_FUNCTION;
         default:
             ESP_LOGE(I2C_TAG, "enableACK(): Failed to install ISR, encountered unknown error. Error=%d.", result);
             return FAILED_TO_INSTALL_ISR_FUNCTION; 
     }
 
-    ptr->useAck = true;
+    bus->isrInstalled = true;
     return OK;
 }
 
@@ -26,12 +26,55 @@
  *      Supports 7bit addressing only.  
  *      Supports slave acknowledge.
  *      Supports write-mode only.
+ *      Supports multiple slaves on one bus, each with its own context.
  *      Does not support multiple-masters.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 #ifndef __i2c_h__
 #define __i2c_h__
 
-RESULT I2C_Initialize(const uint8_t slaveAddress, const gpio_num_t scl, const gpio_num_t sda, const bool useAck, void **context);
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  How the 9th SCL cycle of every byte is used to capture the slave's ACK.
+ *  Values for NONE and ISR match the false/true of the former useAck flag.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef enum _I2C_ACK_MODE {
+    I2C_ACK_NONE   = 0,     // 9th SCL cycle clocked blind, see I2C_SetAckVerify().
+    I2C_ACK_ISR    = 1,     // ACK captured by GPIO interrupt on SDA falling edge.
+    I2C_ACK_POLLED = 2      // SDA released and read directly during 9th SCL cycle. No ISR.
+}I2C_ACK_MODE;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Bus-speed profiles. See timing table in i2c.c.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef enum _I2C_BUS_SPEED {
+    I2C_SPEED_STANDARD,     // 100kHz 
+    I2C_SPEED_FAST,         // 400kHz
+    I2C_SPEED_FAST_PLUS,    // 1MHz
+    I2C_SPEED_MAX           // no SCL delays, START/STOP keep 400kHz timing.
+                            // As fast as the cpu and slave tolerate.
+}I2C_BUS_SPEED;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Max SDA lanes sharing one SCL, see I2C_InitializeLanes().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#define I2C_MAX_LANES   4
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Scatter/gather element used by I2C_WriteBuffers(). 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef struct _I2C_BUFFER {
+    const uint8_t   *data;          // bytes to send, may be NULL only if length is 0.
+    size_t          length;         // number of bytes in data.
+}I2C_BUFFER;
+
+RESULT I2C_Initialize(const uint8_t slaveAddress, const gpio_num_t scl, const gpio_num_t sda, const I2C_ACK_MODE ackMode, 
+                      const I2C_BUS_SPEED speed, void **context);
+
+RESULT I2C_InitializeLanes(const uint8_t slaveAddress, const gpio_num_t scl, const gpio_num_t *sda, const uint8_t laneCount,
+                           const I2C_ACK_MODE ackMode, const I2C_BUS_SPEED speed, void **context);
+
+RESULT I2C_SetBusSpeed(void *context, const I2C_BUS_SPEED speed);
+
+RESULT I2C_SetAckVerify(void *context, const uint32_t everyN);
 
 RESULT I2C_StartXmit(void *context);
 
@@ -39,6 +82,16 @@ RESULT I2C_StopXmit(void *context);
 
 RESULT I2C_Write(void *context, const uint8_t byte);
 
+RESULT I2C_WriteBuffer(void *context, const uint8_t *buffer, const size_t length, size_t *nackOffset);
+
+RESULT I2C_WriteBuffers(void *context, const I2C_BUFFER *buffers, const size_t count, size_t *nackOffset);
+
+RESULT I2C_WriteLanes(void *context, const uint8_t *const *lanes, const size_t length, uint32_t *nackLanes);
+
 RESULT I2C_FreeContext(void **context);
 
+#ifdef DEBUG
+RESULT I2C_BenchmarkKernels(void *context, const uint32_t byteCount);
+#endif
+
 #endif //__i2c_h__
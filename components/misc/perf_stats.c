@@ -0,0 +1,251 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 by Hector Cura Jr. 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+#include "result_codes.h"
+#include "timer_util.h"
+#include "perf_stats.h"
+
+#if PERF_STATS_ENABLED
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Counters are kept in cpu ticks and converted to us when read. Wall time is
+ *  accumulated in steps shorter than the 53s CCOUNT wrap: on every STOP and
+ *  every read, so a periodic log keeps it accurate on an idle bus.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef struct _perf_state_t {
+    PERF_STATS  stats;              // latencies already in us.
+    uint64_t    busyTicks;
+    uint64_t    wallTicks;
+    uint32_t    lastWall;           // cycle count wallTicks was last advanced at.
+    TimerHandle_t logTimer;
+}perf_state_t;
+
+static const char *PERF_TAG = "PERF";
+static perf_state_t STATE = {0};
+
+static const char *API_NAMES[PERF_API_COUNT] = {
+    [PERF_FILL_DISPLAY] = "FillDisplay",
+    [PERF_UPDATE_PAGE]  = "UpdatePage",
+    [PERF_DRAW_LINE]    = "DrawLine",
+    [PERF_DRAW_PIXEL]   = "DrawPixel",
+    [PERF_DRAW_RECTANGLE] = "DrawRectangle",
+    [PERF_DRAW_CIRCLE]  = "DrawCircle",
+    [PERF_FLUSH]        = "Flush",
+    [PERF_CONSOLE_WRITE] = "ConsoleWrite"
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Private method to advance wall time. Interrupts must be disabled.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+advanceWall(uint32_t now)
+{
+    if (STATE.lastWall != 0) {
+        STATE.wallTicks += now - STATE.lastWall;
+    }
+    STATE.lastWall = now;
+}
+
+static void
+logTimerCallback(TimerHandle_t timer)
+{
+    PERF_LogStats();
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Recording methods, called through the PERF_ macros only.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+void
+PERF_EndScope(perf_scope_t *scope)
+{
+    uint32_t us = (PERF_CYCLES() - scope->start) / CPU_FREQ_MHZ;
+    uint32_t bucket = (us == 0) ? 0 : (32 - __builtin_clz(us));
+    if (bucket >= PERF_HISTOGRAM_BUCKETS) {
+        bucket = PERF_HISTOGRAM_BUCKETS-1;
+    }
+
+    PERF_LATENCY *latency = &STATE.stats.api[scope->api];
+    portENTER_CRITICAL();
+    latency->calls++;
+    latency->totalUs += us;
+    latency->buckets[bucket]++;
+    if (us > latency->maxUs) {
+        latency->maxUs = us;
+    }
+    portEXIT_CRITICAL();
+}
+
+void
+PERF_CountBytes(uint32_t count)
+{
+    portENTER_CRITICAL();
+    STATE.stats.bytes += count;
+    portEXIT_CRITICAL();
+}
+
+void
+PERF_CountNack(void)
+{
+    portENTER_CRITICAL();
+    STATE.stats.nacks++;
+    portEXIT_CRITICAL();
+}
+
+uint32_t
+PERF_BusStart(void)
+{
+    portENTER_CRITICAL();
+    STATE.stats.starts++;
+    portEXIT_CRITICAL();
+    return PERF_CYCLES();
+}
+
+void
+PERF_BusStop(uint32_t start)
+{
+    uint32_t now = PERF_CYCLES();
+    portENTER_CRITICAL();
+    STATE.stats.stops++;
+    STATE.busyTicks += now - start;
+    advanceWall(now);
+    portEXIT_CRITICAL();
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Public method to copy the counters gathered since PERF_ResetStats().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+PERF_GetStats(PERF_STATS *stats)
+{
+    if (stats == NULL) {
+        return INVALID_ARGUMENT;
+    }
+
+    uint32_t now = PERF_CYCLES();
+    portENTER_CRITICAL();
+    advanceWall(now);
+    *stats = STATE.stats;
+    stats->busyUs = STATE.busyTicks / CPU_FREQ_MHZ;
+    stats->wallUs = STATE.wallTicks / CPU_FREQ_MHZ;
+    portEXIT_CRITICAL();
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Public method to zero the counters and restart the wall clock.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+PERF_ResetStats(void)
+{
+    uint32_t now = PERF_CYCLES();
+    portENTER_CRITICAL();
+    memset(&STATE.stats, 0, sizeof(STATE.stats));
+    STATE.busyTicks = 0;
+    STATE.wallTicks = 0;
+    STATE.lastWall  = now;
+    portEXIT_CRITICAL();
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Public method to log the counters: bus totals, then one line per method
+ *  that was called, with its non-empty histogram buckets as <limit_us:count.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+PERF_LogStats(void)
+{
+    PERF_STATS stats;
+    PERF_GetStats(&stats);
+
+    uint32_t busyPermille = (stats.wallUs == 0) ? 0 : (uint32_t)((stats.busyUs * 1000) / stats.wallUs);
+    ESP_LOGI(PERF_TAG, "bus: %u bytes, %u START/%u STOP, %u NACK, busy %u.%u%% of %u ms.",
+                        stats.bytes, stats.starts, stats.stops, stats.nacks, 
+                        busyPermille / 10, busyPermille % 10, (uint32_t)(stats.wallUs / 1000));
+
+    for (int x=0; x<PERF_API_COUNT; x++) {
+        const PERF_LATENCY *latency = &stats.api[x];
+        if (latency->calls == 0) {
+            continue;
+        }
+
+        char histogram[PERF_HISTOGRAM_BUCKETS * 16];
+        size_t length = 0;
+        for (int bucket=0; bucket<PERF_HISTOGRAM_BUCKETS; bucket++) {
+            if (latency->buckets[bucket] != 0) {
+                length += snprintf(histogram + length, sizeof(histogram) - length, " <%u:%u", 
+                                    (bucket == PERF_HISTOGRAM_BUCKETS-1) ? 0xFFFFFFFF : (0x1u << bucket), 
+                                    latency->buckets[bucket]);
+                if (length >= sizeof(histogram)) {
+                    length = sizeof(histogram) - 1;         // snprintf returns what it would have written
+                }
+            }
+        }
+        histogram[length] = '\0';
+
+        ESP_LOGI(PERF_TAG, "%-11s: %u calls, avg %u us, max %u us,%s", API_NAMES[x], latency->calls, 
+                            (uint32_t)(latency->totalUs / latency->calls), latency->maxUs, histogram);
+    }
+
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Public methods to log the counters every periodMs from a FreeRTOS timer.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+PERF_StartLogging(uint32_t periodMs)
+{
+    if ((periodMs == 0) || (STATE.logTimer != NULL)) {
+        return INVALID_ARGUMENT;
+    }
+
+    STATE.logTimer = xTimerCreate("perf_log", pdMS_TO_TICKS(periodMs), pdTRUE, NULL, logTimerCallback);
+    if (STATE.logTimer == NULL) {
+        ESP_LOGE(PERF_TAG, "PERF_StartLogging(): Failed to create timer.");
+        return FAILED_TO_ALLOCATE_MEMORY;
+    }
+
+    xTimerStart(STATE.logTimer, portMAX_DELAY);
+    return OK;
+}
+
+RESULT
+PERF_StopLogging(void)
+{
+    if (STATE.logTimer == NULL) {
+        return OK;
+    }
+
+    xTimerDelete(STATE.logTimer, portMAX_DELAY);
+    STATE.logTimer = NULL;
+    return OK;
+}
+
+#endif // PERF_STATS_ENABLED
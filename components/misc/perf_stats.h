@@ -0,0 +1,126 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 by Hector Cura Jr.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *  Description: 
+ *      Optional latency and bus-utilization counters for the I2C and SSD1306
+ *      drivers. Enable from the Makefile with -DPERF_STATS_ENABLED=1. When disabled
+ *      every PERF_ macro compiles to nothing and perf_stats.c is empty.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _perf_stats_h_
+#define _perf_stats_h_
+
+#ifndef PERF_STATS_ENABLED
+#define PERF_STATS_ENABLED  0
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Cycle counter used for every measurement. A host build without
+ *  CCOUNT can supply its own with -DPERF_CYCLES=fakeCycles.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef PERF_CYCLES
+#define PERF_CYCLES     getCCOUNT
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Instrumented public methods.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef enum _PERF_API {
+    PERF_FILL_DISPLAY,
+    PERF_UPDATE_PAGE,
+    PERF_DRAW_LINE,
+    PERF_DRAW_PIXEL,
+    PERF_DRAW_RECTANGLE,
+    PERF_DRAW_CIRCLE,
+    PERF_FLUSH,
+    PERF_CONSOLE_WRITE,
+    PERF_API_COUNT
+}PERF_API;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Latency histogram. Bucket n counts calls that took less than 
+ *  2^n us (and at least 2^(n-1) us), the last bucket everything 
+ *  slower.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#define PERF_HISTOGRAM_BUCKETS  20
+
+typedef struct _PERF_LATENCY {
+    uint32_t    calls;
+    uint32_t    maxUs;
+    uint64_t    totalUs;
+    uint32_t    buckets[PERF_HISTOGRAM_BUCKETS];
+}PERF_LATENCY;
+
+typedef struct _PERF_STATS {
+    PERF_LATENCY    api[PERF_API_COUNT];
+    uint32_t        bytes;          // bytes clocked out, including address bytes. The mock
+                                    // transport counts the command and data bytes it gets.
+    uint32_t        starts;         // START conditions.
+    uint32_t        stops;          // STOP conditions.
+    uint32_t        nacks;          // bytes NACK'd by a slave.
+    uint64_t        busyUs;         // time between START and STOP.
+    uint64_t        wallUs;         // time since PERF_ResetStats().
+}PERF_STATS;
+
+#if PERF_STATS_ENABLED
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Times the rest of the enclosing function, every return path 
+ *  included, and records it against api.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef struct _perf_scope_t {
+    PERF_API    api;
+    uint32_t    start;
+}perf_scope_t;
+
+#define PERF_API_SCOPE(id)                                                  \
+    perf_scope_t __perfScope __attribute__((cleanup(PERF_EndScope))) =      \
+                    { (id), PERF_CYCLES() }
+
+#define PERF_COUNT_BYTES(n)     PERF_CountBytes(n)
+#define PERF_COUNT_NACK()       PERF_CountNack()
+#define PERF_BUS_START(start)   (start) = PERF_BusStart()
+#define PERF_BUS_STOP(start)    PERF_BusStop(start)
+
+void PERF_EndScope(perf_scope_t *scope);
+void PERF_CountBytes(uint32_t count);
+void PERF_CountNack(void);
+uint32_t PERF_BusStart(void);
+void PERF_BusStop(uint32_t start);
+
+RESULT PERF_GetStats(PERF_STATS *stats);
+RESULT PERF_ResetStats(void);
+RESULT PERF_LogStats(void);
+RESULT PERF_StartLogging(uint32_t periodMs);
+RESULT PERF_StopLogging(void);
+
+#else
+
+#define PERF_API_SCOPE(id)
+#define PERF_COUNT_BYTES(n)
+#define PERF_COUNT_NACK()
+#define PERF_BUS_START(start)
+#define PERF_BUS_STOP(start)
+
+#endif // PERF_STATS_ENABLED
+
+#endif // _perf_stats_h_
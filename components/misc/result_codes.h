@@ -29,11 +29,14 @@ typedef enum _RESULT {
     FAILED_READ,
     FAILED_TO_ALLOCATE_MEMORY,
     FAILED_TO_CONFIGURE_I2C_PINS,
+    FAILED_TO_CONFIGURE_SPI,
+    FAILED_TO_CREATE_TASK,
     FAILED_TO_INSTALL_ISR_FUNCTION,
     FAILED_TO_INSTALL_ISR_SERVICE,
     FAILED_TO_SET_INTERRUPT_TYPE,
     FAILED_TO_SET_PIN_LEVEL,
     FAILED_TO_SEND_SLAVE_ADDRESS,
+    FAILED_WRITE,
     FAILED_WRITE_RECEIVED_NACK,
     INVALID_ARGUMENT,
     INVALID_CONTEXT,
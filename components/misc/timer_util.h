@@ -24,24 +24,47 @@
 #ifndef _timer_util_h_
 #define _timer_util_h_
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  CPU clock used to convert between ticks and time. Taken from
+ *  sdkconfig when available, otherwise override from the Makefile
+ *  with -DCPU_FREQ_MHZ=160.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef CPU_FREQ_MHZ
+#ifdef CONFIG_ESP8266_DEFAULT_CPU_FREQ_MHZ
+#define CPU_FREQ_MHZ    CONFIG_ESP8266_DEFAULT_CPU_FREQ_MHZ
+#else
+#define CPU_FREQ_MHZ    80
+#endif
+#endif
+
+#if (CPU_FREQ_MHZ != 80) && (CPU_FREQ_MHZ != 160)
+#error "CPU_FREQ_MHZ must be 80 or 160."
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *  Converts nano-seconds to cpu ticks at compile time. Rounds up
+ *  so that a minimum time is never shortened.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#define NS_TO_TICKS(ns)   ((((ns) * CPU_FREQ_MHZ) + 999) / 1000)
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  *  Convenience values for some common timings.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
-#define TICKS_IN_100_NS    8
-#define TICKS_IN_250_NS   20
-#define TICKS_IN_500_NS   40 
-#define TICKS_IN_300_NS   24
-#define TICKS_IN_600_NS   48
-#define TICKS_IN_750_NS   60
-#define TICKS_IN_900_NS   72 
-#define TICKS_IN_1000_NS  80
-#define TICKS_IN_1300_NS 104
-#define TICKS_IN_2000_NS 160
-#define TICKS_IN_3000_NS 240
-#define TICKS_IN_3450_NS 276
-#define TICKS_IN_4000_NS 320
-#define TICKS_IN_4700_NS 376
-#define TICKS_IN_5000_NS 400
+#define TICKS_IN_100_NS  NS_TO_TICKS(100)
+#define TICKS_IN_250_NS  NS_TO_TICKS(250)
+#define TICKS_IN_500_NS  NS_TO_TICKS(500)
+#define TICKS_IN_300_NS  NS_TO_TICKS(300)
+#define TICKS_IN_600_NS  NS_TO_TICKS(600)
+#define TICKS_IN_750_NS  NS_TO_TICKS(750)
+#define TICKS_IN_900_NS  NS_TO_TICKS(900)
+#define TICKS_IN_1000_NS NS_TO_TICKS(1000)
+#define TICKS_IN_1300_NS NS_TO_TICKS(1300)
+#define TICKS_IN_2000_NS NS_TO_TICKS(2000)
+#define TICKS_IN_3000_NS NS_TO_TICKS(3000)
+#define TICKS_IN_3450_NS NS_TO_TICKS(3450)
+#define TICKS_IN_4000_NS NS_TO_TICKS(4000)
+#define TICKS_IN_4700_NS NS_TO_TICKS(4700)
+#define TICKS_IN_5000_NS NS_TO_TICKS(5000)
  
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  *  Following method returns the current value of special
@@ -57,8 +80,9 @@ inline uint32_t getCCOUNT()
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  *  Following method introduces an approximate delay in ticks.
- *  The ticks are based on cpu clock speed. Default for ESP8266EX
- *  is 80MhZ. This means each tick executes in ~12.5ns.
+ *  The ticks are based on cpu clock speed (CPU_FREQ_MHZ). Default 
+ *  for ESP8266EX is 80MhZ. This means each tick executes in ~12.5ns,
+ *  or ~6.25ns at 160MhZ.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 inline void delay(volatile uint32_t delay_time_in_cpu_ticks) 
 {
@@ -21,10 +21,14 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include <string.h>
 #include <stdlib.h>
 #include <malloc.h>
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
 #include "driver/gpio.h"
 #include "esp8266/rom_functions.h"
 #include "task.h"
@@ -33,7 +37,11 @@
 #include "esp_system.h"
 #include "result_codes.h"
 #include "i2c.h"
+#include "timer_util.h"
+#include "perf_stats.h"
 #include "ssd1306.h"
+#include "ssd1306_transport.h"
+#include "ssd1306_font.h"
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  *  SSD1306 CONTROL BYTE MACROS
@@ -48,12 +56,16 @@
 #define SSD1306_SET_MEMORY_ADDRESSING_MODE          0x20
 #define SSD1306_SET_COLUMN_ADDRESS                  0x21
 #define SSD1306_SET_PAGE_ADDRESS                    0x22
+#define SSD1306_SET_LOWER_COLUMN_START              0x00    // page addressing mode, low nibble in bits 3-0
+#define SSD1306_SET_HIGHER_COLUMN_START             0x10    // page addressing mode, high nibble in bits 2-0
+#define SSD1306_SET_PAGE_START_ADDRESS              0xB0    // page addressing mode, page in bits 2-0
 #define SSD1306_RIGHT_HORIZONTAL_SCROLL             0x26
 #define SSD1306_LEFT_HORIZONTAL_SCROLL              0x27
 #define SSD1306_VERTICAL_RIGHT_HORIZONTAL_SCROLL    0x29
 #define SSD1306_VERTICAL_LEFT_HORIZONTAL_SCROLL     0x2A
 #define SSD1306_DEACTIVATE_SCROLL                   0x2E
 #define SSD1306_ACTIVATE_SCROLL                     0x2F
+#define SSD1306_SET_FADE_OUT_AND_BLINK              0x23
 #define SSD1306_SET_DISPLAY_START_LINE              0x40 
 #define SSD1306_SET_CONTRAST                        0x81
 #define SSD1306_SET_CHARGE_PUMP                     0x8D
@@ -71,6 +83,7 @@
 #define SSD1306_SET_COM_OUTPUT_SCAN_REMAPPED        0xC8
 #define SSD1306_SET_DISPLAY_OFFSET                  0xD3
 #define SSD1306_SET_DCLCK_DIV_RATION_FOSC           0xD5
+#define SSD1306_SET_ZOOM_IN                         0xD6
 #define SSD1306_SET_PRECHARGE_PERIOD                0xD9
 #define SSD1306_SET_COM_PINS_HW_CONFIGURATION       0xDA
 #define SSD1306_SET_VCOMH_DESELECT_LEVEL            0xDB
@@ -94,16 +107,6 @@ if(((ssd1306_t *)(context))->header != (uint32_t)(context)) {               \
 ptr = (ssd1306_t *)context
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
 
-/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
- *  Convenience macro to remove clutter 
- * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
-#define SSD1306_SEND_CMD(ptr, cmd, ret)                                     \
-    ret = sendCommand(ptr, cmd);                                            \
-    if (ret != OK) {                                                        \
-        return ret;                                                         \
-    }                                                                       
-/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
-
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  *  Macros that define/configure the OLED display
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -115,6 +118,97 @@ ptr = (ssd1306_t *)context
 #define SSD1306_VERTICAL_ADDRESSING_MODE    0x01
 #define SSD1306_PAGE_ADDRESSING_MODE        0x02
 #define SSD1306_DEFAULT_ADDRESSING_MODE     SSD1306_HORIZONTAL_ADDRESSING_MODE
+#define SSD1306_CHEAPEST_ADDRESSING_MODE    0xFF   // sendModeWindowBuffers() picks, see chooseAddressingMode()
+#define SSD1306_FRAMEBUFFER_SIZE            (SSD1306_PAGES * SSD1306_SEGMENTS)
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * ACK mode the display's I2C context is created with. Polling avoids an
+ * interrupt per byte. Override with -DSSD1306_I2C_ACK_MODE=I2C_ACK_ISR.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#ifndef SSD1306_I2C_ACK_MODE
+#define SSD1306_I2C_ACK_MODE                I2C_ACK_POLLED
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * With SSD1306_I2C_ACK_MODE=I2C_ACK_NONE, every Nth transaction still reads
+ * ACKs so that a disconnected panel is reported. 0 never checks.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#ifndef SSD1306_I2C_ACK_VERIFY_EVERY
+#define SSD1306_I2C_ACK_VERIFY_EVERY        64
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Window setup goes in the same transaction as its data (transport's 
+ * sendCommandsAndData) when it needs at most this many command bytes. On 
+ * I2C each command byte then needs its own Co=1 control byte (0x80), so n
+ * command bytes cost 2n+2 bytes after the address instead of n+4 over two
+ * transactions. Dropping the second STOP, tBUF and START (2.5us at 
+ * I2C_SPEED_MAX, where bytes are cpu bound) pays for the 3-byte windows left
+ * by SSD1306_TRACK_CURSOR, not for full 6-byte ones. 0 never mixes.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#ifndef SSD1306_MIXED_MAX_COMMANDS
+#define SSD1306_MIXED_MAX_COMMANDS          3
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Bus-speed profile the display's I2C context starts with. SSD1306 is rated 
+ * for 400kHz but tolerates I2C_SPEED_MAX. Change at runtime with 
+ * SSD1306_SetBusSpeed().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#ifndef SSD1306_I2C_BUS_SPEED
+#define SSD1306_I2C_BUS_SPEED               I2C_SPEED_MAX
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Track the controller's GDDRAM address pointer so that window setup which 
+ * would leave it where it already is can be skipped or cut down to the 
+ * column or page range alone. See setWriteLocation(). Set to 0 if anything 
+ * other than this driver writes to the panel.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#ifndef SSD1306_TRACK_CURSOR
+#define SSD1306_TRACK_CURSOR                1
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Let writes that stay inside one page use page addressing mode, where the
+ * pointer is placed with at most 3 one-byte commands (page, column low and
+ * high nibble) instead of the 6-byte column and page ranges. The driver 
+ * switches mode only once the bytes it would have saved pay for the 
+ * switch, see chooseAddressingMode(). Set to 0 to stay in horizontal mode.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#ifndef SSD1306_ADAPTIVE_ADDRESSING
+#define SSD1306_ADAPTIVE_ADDRESSING         1
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Async transmit task configuration. See SSD1306_StartAsync().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#ifndef SSD1306_ASYNC_QUEUE_DEPTH
+#define SSD1306_ASYNC_QUEUE_DEPTH           8       // max requests waiting, must be < 0xFF
+#endif
+#ifndef SSD1306_ASYNC_STACK_SIZE
+#define SSD1306_ASYNC_STACK_SIZE            2048
+#endif
+#define SSD1306_ASYNC_STOP                  0xFF    // queue entry that stops the transmit task
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Serializes bus transactions between tasks. Recursive so that a window
+ * (address setup + data) can be held across its two transactions.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#define LOCK_BUS(ptr)       xSemaphoreTakeRecursive((ptr)->busLock, portMAX_DELAY)
+#define UNLOCK_BUS(ptr)     xSemaphoreGiveRecursive((ptr)->busLock)
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Approximate number of bytes on the wire that a separate window update costs:
+ * the setWriteLocation() transaction (START, address, control byte, 6 commands,
+ * STOP) plus the START, address and control byte of the data transaction.
+ * Flush() merges neighbouring dirty pages into one window when the clean bytes
+ * it would resend cost less than this.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#define SSD1306_WINDOW_OVERHEAD             11
+#define SSD1306_WINDOW_COMMANDS             6       // 0x21 scol ecol 0x22 spage epage
+#define SSD1306_PAGE_COMMANDS               3       // 0xB0|page, column low and high nibble
+#define SSD1306_MODE_SWITCH_COMMANDS        2       // 0x20 mode, in a transaction of its own
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * A PAGE consists of a vertical 8-bit column that spans the width of the
@@ -124,35 +218,272 @@ ptr = (ssd1306_t *)context
 #define PAGE_TURN_COLUMN_ON  0xFF 
 #define PAGE_TURN_COLUMN_OFF 0x00 
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Glyph cache: glyphs already shifted to a row offset within a page, in 
+ * page format. Direct-mapped, allocated on the first SSD1306_DrawText().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#ifndef SSD1306_GLYPH_CACHE_ENTRIES
+#define SSD1306_GLYPH_CACHE_ENTRIES         32     // power of 2
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Applies mask to a GDDRAM byte or word according to an SSD1306_DRAW_MODE.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+#define APPLY_MASK(dst, m, mode) \
+    (((mode) == SSD1306_DRAW_SET)   ? ((dst) |= (m)) : \
+     ((mode) == SSD1306_DRAW_CLEAR) ? ((dst) &= ~(m)) : ((dst) ^= (m)))
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
 #define MIN(x, y)   (x) <= (y) ? (x) : (y)
 #define MAX(x, y)   (x) >  (y) ? (x) : (y)
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * A framebuffer region waiting for, or being sent by, the transmit task.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+typedef struct _async_request_t {
+    uint32_t    sequence;       // transmit order, completion is reported by sequence.
+    uint32_t    enqueued;       // CCOUNT when region was first requested.
+    uint8_t     scol;
+    uint8_t     ecol;
+    uint8_t     spage;
+    uint8_t     epage;
+    bool        pending;        // still in queue, may absorb requests for the same region.
+}async_request_t;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Caller waiting for a request sequence number to complete.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+typedef struct _async_waiter_t {
+    struct _async_waiter_t  *next;
+    uint32_t                ticket;
+    SSD1306_ASYNC_CALLBACK  callback;
+    void                    *arg;
+}async_waiter_t;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * State owned by the async transmit task.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+typedef struct _ssd1306_async_t {
+    TaskHandle_t        task;
+    QueueHandle_t       queue;              // slot indices in transmit order.
+    QueueHandle_t       freeSlots;          // slot indices available for new requests.
+    SemaphoreHandle_t   lock;               // guards slots, waiters and stats.
+    SemaphoreHandle_t   stopped;            // given by transmit task when it exits.
+    uint32_t            nextSequence;
+    uint32_t            completedSequence;
+    async_waiter_t      *waiters;
+    SSD1306_ASYNC_STATS stats;
+    async_request_t     slots[SSD1306_ASYNC_QUEUE_DEPTH];
+}ssd1306_async_t;
+
+typedef struct _glyph_entry_t {
+    const SSD1306_FONT *font;                   // NULL while the entry is empty.
+    uint8_t     code;
+    uint8_t     shift;                          // rows the glyph is moved down within its page.
+    uint8_t     width;
+    uint8_t     columns[(SSD1306_FONT_MAX_PAGES+1) * SSD1306_FONT_MAX_WIDTH];  // page-major, width per page.
+}glyph_entry_t;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * The controller's address window and pointer in horizontal addressing mode:
+ * each data byte lands at (col, page), then col moves right, wrapping to scol
+ * and the next page past ecol, and page wraps to spage past epage.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+typedef struct _cursor_t {
+    bool        valid;                          // false until a window is set, or after a failed transfer.
+    uint8_t     scol;
+    uint8_t     ecol;
+    uint8_t     spage;
+    uint8_t     epage;
+    uint8_t     col;                            // where the next data byte lands.
+    uint8_t     page;
+}cursor_t;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Hardware scroll last started, see SSD1306_StartScroll().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+typedef struct _scroll_state_t {
+    bool        active;
+    bool        vertical;                       // start line moves, restore it on stop.
+    uint8_t     spage;                          // pages whose GDDRAM rotates.
+    uint8_t     epage;
+}scroll_state_t;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Text console, see SSD1306_ConsoleOpen().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+typedef struct _console_state_t {
+    const SSD1306_FONT *font;                   // NULL while the console is closed.
+    uint8_t     nextPage;                       // GDDRAM page the next line is written to.
+    bool        wrapped;                        // every page holds a line, new lines rotate.
+}console_state_t;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Contrast ramp run from a FreeRTOS timer, see SSD1306_StartContrastRamp().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+typedef struct _contrast_ramp_t {
+    TimerHandle_t timer;                        // created by the first ramp, one step per expiry.
+    bool        active;
+    uint8_t     from;
+    uint8_t     to;
+    uint16_t    step;                           // steps sent so far.
+    uint16_t    steps;
+    SSD1306_ASYNC_CALLBACK callback;            // optional, runs on the timer task when the ramp ends.
+    void        *arg;
+}contrast_ramp_t;
+
 typedef struct _ssd1306_t {
     uint32_t    header;
-    void        *i2c;
+    const SSD1306_TRANSPORT *transport;         // how commands and data reach the panel.
+    void        *link;                          // transport's own context, e.g. the I2C context.
+    SemaphoreHandle_t busLock;                  // recursive, see LOCK_BUS.
+    uint8_t     laneCount;                      // panels driven in parallel, see SSD1306_InitializeLanes.
+    ssd1306_async_t   *async;                   // transmit task state, NULL unless async mode started.
+    glyph_entry_t     *glyphs;                  // SSD1306_GLYPH_CACHE_ENTRIES, NULL until text is drawn.
+    uint8_t     *framebuffer;                   // optional shadow of GDDRAM, NULL when disabled.
+    cursor_t    cursor;                         // see SSD1306_TRACK_CURSOR.
+    scroll_state_t    scroll;
+    console_state_t   console;
+    uint8_t     startLine;                      // GDDRAM row shown at the top of the display.
+    uint8_t     contrast;                       // last contrast sent.
+    uint8_t     addressingMode;                 // SSD1306_*_ADDRESSING_MODE the panel is in.
+    uint16_t    modeCredit;                     // bytes the other mode would have saved, see chooseAddressingMode().
+    uint8_t     segmentRemap;                   // last 0xA0/0xA1 sent.
+    uint8_t     comScan;                        // last 0xC0/0xC8 sent.
+    SSD1306_ROTATION  rotation;
+    contrast_ramp_t   ramp;
+    SSD1306_WINDOW_STATS windowStats;
+    uint8_t     dirtyStart[SSD1306_PAGES];      // first column of each page not yet flushed.
+    uint8_t     dirtyEnd[SSD1306_PAGES];        // last column of each page not yet flushed. 
+                                                // Page is clean when dirtyStart > dirtyEnd.
 }ssd1306_t;
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Line raster: the bits a line sets in one page, columns [minCol, maxCol]. 
+ * Lines are walked top to bottom, so each page is visited once.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+typedef struct _line_strip_t {
+    ssd1306_t   *ptr;
+    uint8_t     page;
+    uint8_t     minCol;
+    uint8_t     maxCol;                         // minCol > maxCol when empty.
+    SSD1306_DRAW_MODE mode;                     // how the bits are applied when flushed.
+    RESULT      result;                         // first failure flushing a page.
+    uint8_t     bits[SSD1306_SEGMENTS];
+}line_strip_t;
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Private methods
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
 static RESULT initializeDisplay(ssd1306_t *ptr, uint8_t contrast);
-static RESULT sendCommand(ssd1306_t *ptr, uint8_t cmd);
-static RESULT setWriteLocation(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage);
+static RESULT createContext(const SSD1306_TRANSPORT *transport, void *link, uint8_t laneCount, 
+                            uint8_t contrast, void **context);
+static RESULT i2cSendCommands(void *link, const uint8_t *cmds, size_t length);
+static RESULT i2cSendData(void *link, const I2C_BUFFER *buffers, size_t count);
+static RESULT i2cSendCommandsAndData(void *link, const uint8_t *cmds, size_t length, 
+                                     const I2C_BUFFER *buffers, size_t count);
+static size_t i2cCommandPrefix(const uint8_t *cmds, size_t length, uint8_t *prefix);
+static RESULT i2cSetBusSpeed(void *link, I2C_BUS_SPEED speed);
+static RESULT i2cFreeLink(void **link);
+static RESULT sendCommands(ssd1306_t *ptr, const uint8_t *cmds, size_t length);
+static RESULT sendDataBuffers(ssd1306_t *ptr, const I2C_BUFFER *buffers, size_t count);
+static RESULT sendCommandsAndData(ssd1306_t *ptr, const uint8_t *cmds, size_t length, 
+                                  const I2C_BUFFER *buffers, size_t count);
+static RESULT sendWindow(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage, 
+                         const uint8_t *data, size_t length);
+static RESULT sendWindowBuffers(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage, 
+                                const I2C_BUFFER *buffers, size_t count);
+static RESULT sendModeWindowBuffers(ssd1306_t *ptr, uint8_t mode, uint8_t scol, uint8_t ecol, uint8_t spage, 
+                                    uint8_t epage, const I2C_BUFFER *buffers, size_t count);
+static RESULT setAddressingMode(ssd1306_t *ptr, uint8_t mode);
+static uint8_t chooseAddressingMode(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage, 
+                                    size_t length);
+static size_t buildWindow(const ssd1306_t *ptr, uint8_t mode, uint8_t scol, uint8_t ecol, uint8_t spage, 
+                          uint8_t epage, size_t length, uint8_t *cmds);
+#if SSD1306_ADAPTIVE_ADDRESSING
+static size_t commandCost(const ssd1306_t *ptr, size_t count);
+#endif
+static RESULT flushWindow(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage);
+static bool nextDirtyWindow(ssd1306_t *ptr, uint8_t page, uint8_t *scol, uint8_t *ecol, uint8_t *spage, uint8_t *epage);
+static RESULT enqueueRegion(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage,
+                            uint32_t minTicket, SSD1306_ASYNC_CALLBACK callback, void *arg, uint32_t *ticket);
+static void asyncTransmitTask(void *arg);
+static void markDirty(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage);
+static void markClean(ssd1306_t *ptr);
+static RESULT stopScroll(ssd1306_t *ptr);
+static RESULT setStartLine(ssd1306_t *ptr, uint8_t row);
+static RESULT setContrast(ssd1306_t *ptr, uint8_t contrast);
+static void contrastRampStep(TimerHandle_t timer);
+static RESULT consoleLine(ssd1306_t *ptr, const char **text);
+static RESULT setWriteLocation(ssd1306_t *ptr, const uint8_t *cmds, size_t count);
+static size_t windowCommands(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage, 
+                             size_t length, uint8_t *cmds);
+static void commitWindow(ssd1306_t *ptr, const uint8_t *cmds, size_t length);
+static void advanceCursor(ssd1306_t *ptr, size_t length);
 static RESULT drawPixel(ssd1306_t *ptr, uint8_t row, uint8_t col); 
+static RESULT drawLine(ssd1306_t *ptr, uint8_t r1, uint8_t c1, uint8_t r2, uint8_t c2);
+static void stripInit(line_strip_t *strip, ssd1306_t *ptr, SSD1306_DRAW_MODE mode);
+static void stripRowRun(line_strip_t *strip, uint8_t row, uint8_t c1, uint8_t c2);
+static void stripClippedRowRun(line_strip_t *strip, int row, int c1, int c2);
+static void stripColumnRun(line_strip_t *strip, uint8_t col, uint8_t r1, uint8_t r2);
+static void stripSetPage(line_strip_t *strip, uint8_t page);
+static void stripFlush(line_strip_t *strip);
+static RESULT checkDrawMode(ssd1306_t *ptr, SSD1306_DRAW_MODE mode, const char *fn);
+static inline bool isPortrait(const ssd1306_t *ptr);
+static RESULT checkLandscape(const ssd1306_t *ptr, const char *fn);
+static const glyph_entry_t *cachedGlyph(ssd1306_t *ptr, const SSD1306_FONT *font, char c, uint8_t shift);
+static uint8_t pageMask(uint8_t page, int first, int last);
+static void blitGather(uint8_t *out, const uint8_t *lo, const uint8_t *hi, uint8_t loValid, uint8_t hiValid, 
+                       uint8_t shift, uint8_t scol, uint8_t ecol);
+static void blitApply(uint8_t *dst, const uint8_t *src, const uint8_t *mask, uint8_t scol, uint8_t ecol, 
+                      SSD1306_BLIT_OP op);
+static inline uint32_t loadWord(const uint8_t *p);
+static RESULT applyPageRow(ssd1306_t *ptr, uint8_t page, uint8_t scol, uint8_t ecol, 
+                           uint8_t leftMask, uint8_t innerMask, uint8_t rightMask, SSD1306_DRAW_MODE mode);
+static void applySpan(uint8_t *row, uint8_t scol, uint8_t ecol, uint8_t mask, SSD1306_DRAW_MODE mode);
 
 static const char *SSD_TAG = "SSD1306";
-static const uint8_t PIXEL_ON  = 1;
-static const uint8_t PAGE_COLUMN_ON = PAGE_TURN_COLUMN_ON;
+static const uint8_t CONTROL_COMMAND_STREAM = SSD1306_COMMAND_MULTI_BYTE;
+static const uint8_t CONTROL_DATA_STREAM    = SSD1306_DATA_STREAM;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Bit-banged I2C transport, control bytes select command or data streams.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+const SSD1306_TRANSPORT SSD1306_I2C_TRANSPORT = {
+    .name                = "i2c",
+    .commandOverhead     = 2,                    // address and control byte
+    .sendCommands        = i2cSendCommands,
+    .sendData            = i2cSendData,
+    .sendCommandsAndData = i2cSendCommandsAndData,
+    .setBusSpeed         = i2cSetBusSpeed,
+    .freeLink            = i2cFreeLink
+};
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
  * Public method to initialize the SSD1306 display.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 RESULT 
 SSD1306_Initialize(uint8_t slaveAddress, uint8_t scl, uint8_t sda, uint8_t contrast, void **context)
+{
+    return SSD1306_InitializeLanes(slaveAddress, scl, &sda, 1, contrast, context);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to initialize laneCount SSD1306 displays sharing scl, each on 
+ * its own sda pin, as one context.
+ *
+ *  NOTE
+ *      Commands and the regular drawing methods go to every panel at once, so
+ *      the panels mirror each other. SSD1306_UpdateLanes() sends a different
+ *      frame to each panel in the time it takes to send one.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT 
+SSD1306_InitializeLanes(uint8_t slaveAddress, uint8_t scl, const uint8_t *sda, uint8_t laneCount, 
+                        uint8_t contrast, void **context)
 {
     #ifdef DEBUG
-    ESP_LOGD(SSD_TAG, "SSD1306_Initialize(): Inputs slaveAddress: 0x%x, SCL:%d, SDA:%d.", slaveAddress, scl, sda);
+    ESP_LOGD(SSD_TAG, "SSD1306_Initialize(): Inputs slaveAddress: 0x%x, SCL:%d, SDA:%d, lanes:%d.", 
+                        slaveAddress, scl, (sda != NULL) ? sda[0] : 0, laneCount);
     #endif
 
     if (context == NULL) {
@@ -160,30 +491,78 @@ SSD1306_Initialize(uint8_t slaveAddress, uint8_t scl, uint8_t sda, uint8_t contr
         return INVALID_ARGUMENT;    
     }
 
+    if ((sda == NULL) || (laneCount == 0) || (laneCount > I2C_MAX_LANES)) {
+        ESP_LOGE(SSD_TAG, "SSD1306_Initialize(): Need 1 to %d SDA lanes, got %d.", I2C_MAX_LANES, laneCount);
+        return INVALID_ARGUMENT;    
+    }
+
+    gpio_num_t sdaPins[I2C_MAX_LANES];
+    for (uint8_t x=0; x<laneCount; x++) {
+        sdaPins[x] = (gpio_num_t)sda[x];
+    }
+
     void *i2c = NULL;
-    RESULT ret = I2C_Initialize(slaveAddress, scl, sda, true, &i2c);
+    RESULT ret = I2C_InitializeLanes(slaveAddress, scl, sdaPins, laneCount, 
+                                     SSD1306_I2C_ACK_MODE, SSD1306_I2C_BUS_SPEED, &i2c);
 
     if (ret != OK) {
         ESP_LOGE(SSD_TAG, "SSD1306_Initialize(): Failed to initialize I2C. Error=%d.", ret);
         return ret; 
     }
 
-    ssd1306_t *ptr = (ssd1306_t *)malloc(sizeof(ssd1306_t));
-    if (ptr == NULL) {
-        ESP_LOGE(SSD_TAG, "SSD1306_Initialize(): Failed to allocate memory for display context!");
-        return FAILED_TO_ALLOCATE_MEMORY;    
+    if ((SSD1306_I2C_ACK_MODE == I2C_ACK_NONE) && (SSD1306_I2C_ACK_VERIFY_EVERY != 0)) {
+        ret = I2C_SetAckVerify(i2c, SSD1306_I2C_ACK_VERIFY_EVERY);
+        if (ret != OK) {
+            ESP_LOGE(SSD_TAG, "SSD1306_Initialize(): Failed to set ACK verification. Error=%d.", ret);
+            I2C_FreeContext(&i2c);
+            return ret;
+        }
     }
 
-    ptr->header   = (uint32_t)ptr;
-    ptr->i2c      = i2c;
-    *context = (void *)ptr;
+    return createContext(&SSD1306_I2C_TRANSPORT, i2c, laneCount, contrast, context);
+}
 
-    ret = initializeDisplay(ptr, contrast);
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to initialize an SSD1306 display wired for 4-wire SPI to the
+ * ESP8266 HSPI pins. See SSD1306_SpiOpen().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT 
+SSD1306_InitializeSPI(const SSD1306_SPI_CONFIG *config, uint8_t contrast, void **context)
+{
+    void *link = NULL;
+    RESULT ret = SSD1306_SpiOpen(config, &link);
     if (ret != OK) {
-        ESP_LOGE(SSD_TAG, "SSD1306_Initialize(): Failed to initialize display. Error = %d.", ret);
+        ESP_LOGE(SSD_TAG, "SSD1306_InitializeSPI(): Failed to initialize SPI. Error=%d.", ret);
+        return ret;
     }
 
-    return ret; 
+    return SSD1306_InitializeTransport(&SSD1306_SPI_TRANSPORT, link, contrast, context);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to initialize an SSD1306 display over any transport.
+ *
+ *  INPUT
+ *      transport - e.g. SSD1306_MOCK_TRANSPORT.
+ *      link      - transport context, owned by the display from here on, even
+ *                  on failure. Freed by SSD1306_FreeContext().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT 
+SSD1306_InitializeTransport(const SSD1306_TRANSPORT *transport, void *link, uint8_t contrast, void **context)
+{
+    if ((transport == NULL) || (transport->sendCommands == NULL) || (transport->sendData == NULL) ||
+        (transport->setBusSpeed == NULL) || (transport->freeLink == NULL)) {
+        ESP_LOGE(SSD_TAG, "SSD1306_InitializeTransport(): Incomplete transport.");
+        return INVALID_ARGUMENT;
+    }
+
+    if (context == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_InitializeTransport(): Context pointer cannot be null.");
+        transport->freeLink(&link);
+        return INVALID_ARGUMENT;    
+    }
+
+    return createContext(transport, link, 1, contrast, context);
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -199,13 +578,31 @@ RESULT SSD1306_FreeContext(void **ppContext)
 
     ASSIGN_CONTEXT(ptr, *ppContext, "SSD1306_FreeContext");
 
-    RESULT ret = I2C_FreeContext(&ptr->i2c);
+    if (ptr->async != NULL) {
+        SSD1306_StopAsync(ptr);
+    }
+
+    if (ptr->ramp.timer != NULL) {
+        // Steps never block, and while the lock is held here one that runs 
+        // returns without touching the panel. The timer task outranks 
+        // application tasks, so the delete is processed before xTimerDelete()
+        // returns and no step can run on a freed context.
+        LOCK_BUS(ptr);
+        SSD1306_StopContrastRamp(ptr);
+        xTimerDelete(ptr->ramp.timer, portMAX_DELAY);
+        UNLOCK_BUS(ptr);
+    }
+
+    RESULT ret = ptr->transport->freeLink(&ptr->link);
 
     if (ret != OK) {
-        ESP_LOGE(SSD_TAG, "FreeContext(): Failed to free I2C context!");
+        ESP_LOGE(SSD_TAG, "FreeContext(): Failed to free %s context!", ptr->transport->name);
         return ret;
     }
 
+    vSemaphoreDelete(ptr->busLock);
+    free(ptr->glyphs);
+    free(ptr->framebuffer);
     free(ptr);
     *ppContext = NULL; 
     return ret;
@@ -223,13 +620,9 @@ SSD1306_TurnDisplayOn(const void *context)
 
     ssd1306_t *ptr;
     ASSIGN_CONTEXT(ptr, context, "SSD1306_DisplayOn");
-    RESULT ret;
-    I2C_StartXmit(ptr->i2c);
-    SSD1306_SEND_CMD(ptr, SSD1306_COMMAND_SINGLE_BYTE, ret);
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_DISPLAY_ON, ret);
-    I2C_StopXmit(ptr->i2c);
 
-    return OK;
+    const uint8_t cmds[] = { SSD1306_SET_DISPLAY_ON };
+    return sendCommands(ptr, cmds, sizeof(cmds));
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -244,13 +637,9 @@ SSD1306_TurnDisplayOff(const void *context)
 
     ssd1306_t *ptr;
     ASSIGN_CONTEXT(ptr, context, "SSD1306_DisplayOff");
-    RESULT ret;
-    I2C_StartXmit(ptr->i2c);
-    SSD1306_SEND_CMD(ptr, SSD1306_COMMAND_SINGLE_BYTE, ret);
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_DISPLAY_OFF, ret);
-    I2C_StopXmit(ptr->i2c);
 
-    return OK;
+    const uint8_t cmds[] = { SSD1306_SET_DISPLAY_OFF };
+    return sendCommands(ptr, cmds, sizeof(cmds));
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -259,6 +648,7 @@ SSD1306_TurnDisplayOff(const void *context)
 RESULT
 SSD1306_FillDisplay(const void *context, uint8_t fillChar)
 {
+    PERF_API_SCOPE(PERF_FILL_DISPLAY);
     ssd1306_t *ptr;
     ASSIGN_CONTEXT(ptr, context, "SSD1306_DisplayOn");
 
@@ -266,24 +656,28 @@ SSD1306_FillDisplay(const void *context, uint8_t fillChar)
     ESP_LOGD(SSD_TAG, "SSD1306_FillDisplay(): Filling display with fillChar 0x%x", fillChar);
     #endif
 
-    RESULT ret = setWriteLocation(ptr, 0, SSD1306_WIDTH-1, 0, SSD1306_PAGES-1);
-    if (ret != OK) {
-        return ret;
+    if (ptr->framebuffer != NULL) {
+        memset(ptr->framebuffer, fillChar, SSD1306_FRAMEBUFFER_SIZE);
+        markDirty(ptr, 0, SSD1306_WIDTH-1, 0, SSD1306_PAGES-1);
+        return OK;
     }
 
-    for (int page=0; page<64; page++) {                         // each pass fills in a new page-worth of data  
-        I2C_StartXmit(ptr->i2c);
-        SSD1306_SEND_CMD(ptr, SSD1306_DATA_STREAM, ret);        
-        for (int col=0; col<16; col++) {                        // each pass fills in 16x8=128 bits of info
-            ret = I2C_Write(ptr->i2c, fillChar);
-            if (ret != OK) {
-                ESP_LOGE(SSD_TAG, "SSD1306_FillDisplay(): Failed to send data byte: 0x%x! Error = %d", fillChar, ret);
-            }
-        }
-        I2C_StopXmit(ptr->i2c);
+    // One page of fill, streamed once per page in a single data transaction.
+    uint8_t fill[SSD1306_SEGMENTS];
+    memset(fill, fillChar, sizeof(fill));
+
+    I2C_BUFFER buffers[SSD1306_PAGES];
+    for (int page=0; page<SSD1306_PAGES; page++) {
+        buffers[page].data   = fill;
+        buffers[page].length = sizeof(fill);
+    }
+
+    RESULT ret = sendWindowBuffers(ptr, 0, SSD1306_WIDTH-1, 0, SSD1306_PAGES-1, buffers, SSD1306_PAGES);
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_FillDisplay(): Failed to fill display with 0x%x! Error = %d", fillChar, ret);
     }
 
-    return OK; 
+    return ret; 
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -310,17 +704,27 @@ SSD1306_ClearDisplay(const void *context)
  * NOTE
  *  point.row must be less than SSD1306_HEIGHT
  *  point.col must be less than SSD1306_WIDTH
+ *  At 90 and 270 degrees these are portrait coordinates, less than 
+ *  SSD1306_PORTRAIT_HEIGHT and SSD1306_PORTRAIT_WIDTH.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 RESULT
 SSD1306_DrawPixel(const void *context, uint8_t row, uint8_t col) 
 {
+    PERF_API_SCOPE(PERF_DRAW_PIXEL);
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_DrawPixel");
+
+    // a portrait row is a GDDRAM column, see SSD1306_SetRotation().
+    if (isPortrait(ptr)) {
+        const uint8_t tmp = row;
+        row = col;
+        col = tmp;
+    }
+
     if ((row >= SSD1306_HEIGHT) || (col >= SSD1306_WIDTH)) {
         return COORDINATE_OUT_OF_RANGE;
     }
 
-    ssd1306_t *ptr;
-    ASSIGN_CONTEXT(ptr, context, "SSD1306_DrawPixel");
-
     return drawPixel(ptr, row, col);
 
 }
@@ -329,171 +733,1355 @@ SSD1306_DrawPixel(const void *context, uint8_t row, uint8_t col)
  * Public method to draw a line from point p1 to point p2.
  *  
  *  NOTE
- *      Algo: calculate slope then light up points between the two points.
- *            row in [0, 64], col in [0, 128] inclusive
+ *      Algo: integer Bresenham, see drawLine(). Both endpoints are lit.
+ *            row in [0, 64), col in [0, 128); larger values are clamped.
+ *            At 90 and 270 degrees, portrait coordinates: row in [0, 128),
+ *            col in [0, 64).
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 RESULT
 SSD1306_DrawLine(const void *context, const POINT p1, const POINT p2)
 {
-    if ((p2.col == p1.col) && (p2.row == p1.row)) {
-        ESP_LOGE(SSD_TAG, "SSD1306_DrawLine(): Points are identical. No line possible.");
-        return OK;  // technically this is not an error.
-    }
-
+    PERF_API_SCOPE(PERF_DRAW_LINE);
     ssd1306_t *ptr;
-    ASSIGN_CONTEXT(ptr, context, "SSD1306_DrawPixel");
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_DrawLine");
+
+    const bool portrait = isPortrait(ptr);
 
     // clip the points if they're out of range
-    uint8_t r1 = MIN(p1.row, SSD1306_HEIGHT);
-    uint8_t r2 = MIN(p2.row, SSD1306_HEIGHT);
-    uint8_t c1 = MIN(p1.col, SSD1306_WIDTH);
-    uint8_t c2 = MIN(p2.col, SSD1306_WIDTH);
-
-    // identify extrema for points
-    uint8_t minRow = MIN(r1, r2);
-    uint8_t maxRow = MAX(r1, r2);
-    uint8_t minCol = MIN(c1, c2);
-    uint8_t maxCol = MAX(c1, c2);
-
-    // identify affected pages
-    uint8_t minPage = minRow/SSD1306_PAGES;
-    uint8_t maxPage = maxRow/SSD1306_PAGES;
-
-    if (r1 == r2) {
-        RESULT ret = setWriteLocation(ptr, minCol, maxCol, minPage, maxPage); 
-        if (ret != OK) {
-            ESP_LOGE(SSD_TAG, "SSD1306_DrawLine(): Failed to set cursor position. p1=(%d, %d), p2=(%d, %d).",
-                        p1.row, p1.col, p2.row, p2.col);
-            return ret;
-        }
+    uint8_t r1 = MIN(portrait ? p1.col : p1.row, SSD1306_HEIGHT-1);
+    uint8_t r2 = MIN(portrait ? p2.col : p2.row, SSD1306_HEIGHT-1);
+    uint8_t c1 = MIN(portrait ? p1.row : p1.col, SSD1306_WIDTH-1);
+    uint8_t c2 = MIN(portrait ? p2.row : p2.col, SSD1306_WIDTH-1);
 
-        // horizontal line - slope is infinite
-        I2C_StartXmit(ptr->i2c);
-        SSD1306_SEND_CMD(ptr, SSD1306_DATA_STREAM, ret);        
-        for (uint8_t x=minCol; x<maxCol; x++) { 
-            I2C_Write(ptr->i2c, 1<<(r1-(8*minPage)));       // doesn't matter which page since r1==r2
-        }
-        I2C_StopXmit(ptr->i2c);
+    RESULT ret = drawLine(ptr, r1, c1, r2, c2);
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_DrawLine(): Failed to draw line. p1=(%d, %d), p2=(%d, %d).",
+                    p1.row, p1.col, p2.row, p2.col);
+    }
 
-    } else if (c1 == c2) {
-        RESULT ret = setWriteLocation(ptr, minCol, maxCol, minPage, maxPage); 
-        if (ret != OK) {
-            ESP_LOGE(SSD_TAG, "SSD1306_DrawLine(): Failed to set cursor position. p1=(%d, %d), p2=(%d, %d).",
-                        p1.row, p1.col, p2.row, p2.col);
-            return ret;
-        }
+    return ret;
+}
 
-        // vertical line - slope is zero
-        uint8_t row = minRow, col_state, bit;;
-        
-        for (uint8_t x=minPage; x<maxPage+1; x++) {
-            col_state = 0;
-            bit = 0;
-            I2C_StartXmit(ptr->i2c);
-            SSD1306_SEND_CMD(ptr, SSD1306_DATA_STREAM, ret);
-            // identify all the column bits that need to be turned on in the current page.
-            while ((bit < 8) && (row <= maxRow)) {
-                // this bit needs to be turned on if it lies within the range of the current row values.
-                if (row == ((8*x)+bit)) {
-                    col_state |= 1<<(row-(8*x));
-                    row++;  // move on to next row bit
-                }
-                bit++;
-            } 
-            I2C_Write(ptr->i2c, col_state);
-            I2C_StopXmit(ptr->i2c);
-        }
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to draw an axis-aligned rectangle with opposite corners p1
+ * and p2, both inclusive. Parts past the right or bottom edge are clipped.
+ *
+ *  NOTE
+ *      Algo: each page the rectangle covers is one mask for its edge columns
+ *            and one for the columns in between, applied a word at a time.
+ *            Without the framebuffer a filled rectangle, and the pages an 
+ *            outline's top or bottom edge falls in, are one window per page; 
+ *            other pixels in those bytes, inside or outside the rectangle, 
+ *            are turned off. The outline's other pages are two one-column 
+ *            windows for its sides, so pixels inside it are kept.
+ *      At 90 and 270 degrees the corners are portrait coordinates.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_DrawRectangle(const void *context, const POINT p1, const POINT p2, bool filled, SSD1306_DRAW_MODE mode) 
+{
+    PERF_API_SCOPE(PERF_DRAW_RECTANGLE);
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_DrawRectangle");
+
+    RESULT ret = checkDrawMode(ptr, mode, "SSD1306_DrawRectangle");
+    if (ret != OK) {
+        return ret;
+    }
+
+    const bool portrait = isPortrait(ptr);
+    uint8_t r0 = portrait ? MIN(p1.col, p2.col) : MIN(p1.row, p2.row);
+    uint8_t r1 = portrait ? MAX(p1.col, p2.col) : MAX(p1.row, p2.row);
+    uint8_t c0 = portrait ? MIN(p1.row, p2.row) : MIN(p1.col, p2.col);
+    uint8_t c1 = portrait ? MAX(p1.row, p2.row) : MAX(p1.col, p2.col);
+    if ((r0 >= SSD1306_HEIGHT) || (c0 >= SSD1306_WIDTH)) {
+        return OK;                                          // entirely off screen
+    }
 
-    } else { 
-        // transverse line
-        // (y - y1) = m(x2 - x1) --> y = mx + b
-        // m = slope (y2-y1/x2-x1)
-        // b = y1 - m(x1)
-        double m = (double)(r2-r1)/(c2-c1);
-        double b = (double)r1 - (m * c1);
-        drawPixel(ptr, minRow, minCol);
-        while (minCol < maxCol) {
-            minRow = (m * minCol) + b;
-            drawPixel(ptr, minRow, minCol);
-            minCol++;
+    bool bottomEdge = (r1 < SSD1306_HEIGHT);
+    bool rightEdge  = (c1 < SSD1306_WIDTH);
+    uint8_t lastRow = MIN(r1, SSD1306_HEIGHT-1);
+    uint8_t lastCol = MIN(c1, SSD1306_WIDTH-1);
+
+    LOCK_BUS(ptr);
+    for (uint8_t page = r0/8; (page <= lastRow/8) && (ret == OK); page++) {
+        uint8_t edge  = pageMask(page, r0, lastRow);
+        uint8_t inner = edge;
+        if (!filled) {
+            inner = pageMask(page, r0, r0) | (bottomEdge ? pageMask(page, r1, r1) : 0);
         }
-        drawPixel(ptr, maxRow, maxCol);  
+        ret = applyPageRow(ptr, page, c0, lastCol, edge, inner, rightEdge ? edge : inner, mode);
     }
+    UNLOCK_BUS(ptr);
 
-    return NOT_IMPLEMENTED;
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_DrawRectangle(): Failed to draw rectangle. Error = %d", ret);
+    }
+
+    return ret;
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to draw a circle. Parts off screen are clipped.
  *
+ *  NOTE
+ *      Algo: the midpoint algorithm gives the circle's half-width on each 
+ *            row; filled circles are one span per row, outlines the span's 
+ *            ends down to where the next row out begins. Spans are gathered
+ *            per page, so each pixel is applied once, even in invert mode.
+ *      At 90 and 270 degrees the center is a portrait coordinate.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 RESULT
-SSD1306_DrawRectangle(const void *context, const POINT p1, const POINT p2, const POINT p3, const POINT p4) 
+SSD1306_DrawCircle(const void *context, const POINT center, uint8_t radius, bool filled, SSD1306_DRAW_MODE mode)
 {
-    return NOT_IMPLEMENTED;
+    PERF_API_SCOPE(PERF_DRAW_CIRCLE);
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_DrawCircle");
+
+    RESULT ret = checkDrawMode(ptr, mode, "SSD1306_DrawCircle");
+    if (ret != OK) {
+        return ret;
+    }
+
+    // a circle is its own transpose, only the center moves in portrait.
+    const int crow = isPortrait(ptr) ? center.col : center.row;
+    const int ccol = isPortrait(ptr) ? center.row : center.col;
+
+    // halfWidth[d] = how far the circle reaches left and right d rows from center.
+    uint8_t halfWidth[UINT8_MAX+2] = {0};
+    int x = radius;
+    int y = 0;
+    int err = 1 - radius;
+    while (x >= y) {
+        halfWidth[y] = MAX(halfWidth[y], x);
+        halfWidth[x] = MAX(halfWidth[x], y);
+        y++;
+        if (err < 0) {
+            err += 2*y + 1;
+        } else {
+            x--;
+            err += 2*(y - x) + 1;
+        }
+    }
+
+    line_strip_t strip;
+    stripInit(&strip, ptr, mode);
+
+    LOCK_BUS(ptr);
+    for (int d = -radius; d <= radius; d++) {
+        int dist = (d < 0) ? -d : d;
+        int row  = crow + d;
+        int w    = halfWidth[dist];
+        if (filled || (dist == radius)) {
+            stripClippedRowRun(&strip, row, ccol - w, ccol + w);
+        } else {
+            // outline: from this row's reach in to just past the next row's
+            int in = MIN(halfWidth[dist+1] + 1, w);
+            stripClippedRowRun(&strip, row, ccol - w, ccol - in);
+            stripClippedRowRun(&strip, row, ccol + in, ccol + w);
+        }
+    }
+    stripFlush(&strip);
+    UNLOCK_BUS(ptr);
+
+    if (strip.result != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_DrawCircle(): Failed to draw circle. Error = %d", strip.result);
+    }
+
+    return strip.result;
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to draw a line of text with its top-left corner at origin.
+ * Text past the right or bottom edge is clipped; characters outside the 
+ * font are drawn as its defaultChar.
  *
+ *  NOTE
+ *      Algo: glyphs are laid out in a page-format strip from the glyph 
+ *            cache; text on a page boundary is plain copies, otherwise the
+ *            cache holds each glyph pre-shifted across two pages. The strip
+ *            is then merged into the framebuffer, or sent as one window in
+ *            which the text's background is turned off.
+ *      Glyphs are laid out in pages, so text needs a 0 or 180 degree 
+ *      rotation.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 RESULT
-SSD1306_DrawCircle(const void *context, const POINT center, uint8_t radius)
+SSD1306_DrawText(const void *context, const POINT origin, const SSD1306_FONT *font, const char *text, 
+                 SSD1306_DRAW_MODE mode)
 {
-    return NOT_IMPLEMENTED;
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_DrawText");
+
+    if ((font == NULL) || (text == NULL)) {
+        ESP_LOGE(SSD_TAG, "SSD1306_DrawText(): font and text cannot be NULL.");
+        return INVALID_ARGUMENT;
+    }
+
+    if ((font->height == 0) || (font->height > SSD1306_FONT_MAX_HEIGHT) || 
+        ((font->widths == NULL) && (font->width > SSD1306_FONT_MAX_WIDTH))) {
+        ESP_LOGE(SSD_TAG, "SSD1306_DrawText(): Fonts are limited to %dx%d.", SSD1306_FONT_MAX_WIDTH, SSD1306_FONT_MAX_HEIGHT);
+        return INVALID_ARGUMENT;
+    }
+
+    RESULT ret = checkDrawMode(ptr, mode, "SSD1306_DrawText");
+    if (ret == OK) {
+        ret = checkLandscape(ptr, "SSD1306_DrawText");
+    }
+    if ((ret != OK) || (origin.row >= SSD1306_HEIGHT) || (origin.col >= SSD1306_WIDTH)) {
+        return ret;
+    }
+
+    uint8_t shift     = origin.row & 7;
+    uint8_t firstPage = origin.row / 8;
+    uint8_t pages     = (shift + font->height + 7) / 8;
+    pages = MIN(pages, SSD1306_PAGES - firstPage);
+
+    uint8_t strip[SSD1306_FONT_MAX_PAGES+1][SSD1306_SEGMENTS];
+    uint8_t col = origin.col;
+    uint8_t lastCol = origin.col;                           // last column of the last glyph
+
+    LOCK_BUS(ptr);
+    for (; (*text != '\0') && (col < SSD1306_WIDTH); text++) {
+        const glyph_entry_t *glyph = cachedGlyph(ptr, font, *text, shift);
+        if (glyph == NULL) {
+            ret = FAILED_TO_ALLOCATE_MEMORY;
+            break;
+        }
+        if (glyph->width == 0) {
+            continue;
+        }
+
+        uint8_t width = MIN(glyph->width, SSD1306_WIDTH - col);
+        for (uint8_t p = 0; p < pages; p++) {
+            memcpy(&strip[p][col], &glyph->columns[p * glyph->width], width);
+        }
+        lastCol = col + width - 1;
+
+        // blank spacing, clipped to the screen
+        uint8_t gap = MIN(font->spacing, SSD1306_WIDTH - (col + width));
+        for (uint8_t p = 0; p < pages; p++) {
+            memset(&strip[p][col + width], 0, gap);
+        }
+        col += width + gap;
+    }
+
+    if ((ret != OK) || (col == origin.col)) {
+        UNLOCK_BUS(ptr);
+        if (ret != OK) {
+            ESP_LOGE(SSD_TAG, "SSD1306_DrawText(): Failed to draw text. Error = %d", ret);
+        }
+        return ret;                                         // no glyph cache, or nothing drawable
+    }
+
+    uint8_t width = lastCol - origin.col + 1;
+    if (ptr->framebuffer != NULL) {
+        for (uint8_t p = 0; p < pages; p++) {
+            uint8_t *dst = ptr->framebuffer + ((firstPage + p) * SSD1306_SEGMENTS);
+            for (uint8_t x = origin.col; x <= lastCol; x++) {
+                APPLY_MASK(dst[x], strip[p][x], mode);
+            }
+        }
+        markDirty(ptr, origin.col, lastCol, firstPage, firstPage + pages - 1);
+    } else {
+        I2C_BUFFER buffers[SSD1306_FONT_MAX_PAGES+1];
+        for (uint8_t p = 0; p < pages; p++) {
+            if (mode == SSD1306_DRAW_CLEAR) {
+                memset(&strip[p][origin.col], 0, width);
+            }
+            buffers[p].data   = &strip[p][origin.col];
+            buffers[p].length = width;
+        }
+        ret = sendWindowBuffers(ptr, origin.col, lastCol, firstPage, firstPage + pages - 1, buffers, pages);
+    }
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_DrawText(): Failed to draw text. Error = %d", ret);
+    }
+
+    return ret;
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- * Public method to update one of the device's PAGEs. 
+ * Public method to turn the display into a text console of SSD1306_PAGES 
+ * lines. The display is cleared and lines are added with 
+ * SSD1306_ConsoleWrite().
+ *
+ *  NOTE
+ *      Lines live one per GDDRAM page. When the display is full, the next 
+ *      line overwrites the oldest page and the display start line moves 
+ *      down one page, so scrolling costs a one-byte command instead of 
+ *      resending the whole screen.
+ *      The font must fit in one page (height <= 8).
+ *      The framebuffer mirrors GDDRAM, not the picture: while the start 
+ *      line is moved its pages are shown rotated, and so are other drawing
+ *      calls. Close the console before drawing elsewhere.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 RESULT
-SSD1306_UpdatePage(const void *context, uint8_t pageId, const PAGE *page) 
+SSD1306_ConsoleOpen(const void *context, const SSD1306_FONT *font)
 {
     ssd1306_t *ptr;
-    ASSIGN_CONTEXT(ptr, context, "SSD1306_UpdatePage");
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_ConsoleOpen");
 
-    #if DEBUG
-    ESP_LOGD(SSD_TAG, "SSD1306_UpdatePage(): called to update PAGE[%d].", pageId);
-    #endif
-
-    if (pageId > (SSD1306_PAGES-1)) {
-        ESP_LOGE(SSD_TAG, "SSD1306_UpdatePage(): pageId (%d) cannot be greater than %d.", pageId, SSD1306_PAGES-1);
-        return INVALID_ARGUMENT; 
+    if ((font == NULL) || (font->height == 0) || (font->height > 8) || 
+        ((font->widths == NULL) && (font->width > SSD1306_FONT_MAX_WIDTH))) {
+        ESP_LOGE(SSD_TAG, "SSD1306_ConsoleOpen(): Console fonts must be 1 to 8 rows high.");
+        return INVALID_ARGUMENT;
     }
 
-    RESULT ret = setWriteLocation(ptr, 0, SSD1306_WIDTH-1, pageId, pageId);
+    RESULT ret = checkLandscape(ptr, "SSD1306_ConsoleOpen");
     if (ret != OK) {
         return ret;
     }
 
-    I2C_StartXmit(ptr->i2c);
-    SSD1306_SEND_CMD(ptr, SSD1306_DATA_STREAM, ret);            
-    for (int col=0; col<16; col++) {                     
-        ret = I2C_Write(ptr->i2c, page->page[col]);
-        if (ret != OK) {
-            ESP_LOGE(SSD_TAG, "SSD1306_UpdatePage(): Failed to send data byte: 0x%x! Error = %d", page->page[col], ret);
+    LOCK_BUS(ptr);
+    ret = (ptr->startLine != 0) ? setStartLine(ptr, 0) : OK;
+    if (ret == OK) {
+        ret = SSD1306_ClearDisplay(context);
+    }
+    if ((ret == OK) && (ptr->framebuffer != NULL)) {
+        ret = flushWindow(ptr, 0, SSD1306_WIDTH-1, 0, SSD1306_PAGES-1);
+        if (ret == OK) {
+            markClean(ptr);
         }
     }
-    I2C_StopXmit(ptr->i2c);
-    return OK;
+    if (ret == OK) {
+        ptr->console.font     = font;
+        ptr->console.nextPage = 0;
+        ptr->console.wrapped  = false;
+    }
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_ConsoleOpen(): Failed to open console. Error = %d.", ret);
+    }
+    return ret;
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- * Public method to set the contrast level.
+ * Public method to append text to the console. Each '\n' ends a line and 
+ * text wider than the display wraps onto the next; a trailing '\n' does not
+ * add an empty line.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
-RESULT SSD1306_SetContrast(const void *context, uint8_t contrast)
+RESULT
+SSD1306_ConsoleWrite(const void *context, const char *text)
 {
+    PERF_API_SCOPE(PERF_CONSOLE_WRITE);
     ssd1306_t *ptr;
-    ASSIGN_CONTEXT(ptr, context, "SSD1306_SetContrast");
-    
-    RESULT ret;
-    I2C_StartXmit(ptr->i2c);
-    SSD1306_SEND_CMD(ptr, SSD1306_COMMAND_MULTI_BYTE, ret);     
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_CONTRAST, ret);
-    SSD1306_SEND_CMD(ptr, contrast, ret);
-    I2C_StopXmit(ptr->i2c);
-    return OK;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_ConsoleWrite");
+
+    if (text == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_ConsoleWrite(): text cannot be NULL.");
+        return INVALID_ARGUMENT;
+    }
+
+    RESULT ret = OK;
+    LOCK_BUS(ptr);
+    if (ptr->console.font == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_ConsoleWrite(): Console is not open, see SSD1306_ConsoleOpen().");
+        ret = INVALID_STATE_CHANGE_REQUEST;
+    } else {
+        ret = checkLandscape(ptr, "SSD1306_ConsoleWrite");
+    }
+    while ((ret == OK) && (*text != '\0')) {
+        ret = consoleLine(ptr, &text);
+    }
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_ConsoleWrite(): Failed to write to console. Error = %d.", ret);
+    }
+    return ret;
 }
 
-/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to leave console mode. The start line is put back, so the 
+ * lines stay on the display but in GDDRAM order.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_ConsoleClose(const void *context)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_ConsoleClose");
+
+    LOCK_BUS(ptr);
+    RESULT ret = (ptr->startLine != 0) ? setStartLine(ptr, 0) : OK;
+    ptr->console.font = NULL;
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_ConsoleClose(): Failed to restore the start line. Error = %d.", ret);
+    }
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to update one of the device's PAGEs. 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_UpdatePage(const void *context, uint8_t pageId, const PAGE *page) 
+{
+    return SSD1306_UpdatePages(context, pageId, 1, page);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to update count consecutive PAGEs starting at firstPage. The
+ * window is set once and all pages are streamed in one data transaction, so
+ * a full frame costs two transactions.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_UpdatePages(const void *context, uint8_t firstPage, uint8_t count, const PAGE *pages) 
+{
+    PERF_API_SCOPE(PERF_UPDATE_PAGE);
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_UpdatePages");
+
+    #if DEBUG
+    ESP_LOGD(SSD_TAG, "SSD1306_UpdatePages(): called to update PAGE[%d-%d].", firstPage, firstPage+count-1);
+    #endif
+
+    if (pages == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdatePages(): pages cannot be NULL.");
+        return INVALID_ARGUMENT; 
+    }
+
+    if ((count == 0) || (firstPage > (SSD1306_PAGES-1)) || (count > (SSD1306_PAGES-firstPage))) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdatePages(): PAGE[%d] + %d does not fit in %d pages.", firstPage, count, SSD1306_PAGES);
+        return INVALID_ARGUMENT; 
+    }
+
+    uint8_t lastPage = firstPage + count - 1;
+    if (ptr->framebuffer != NULL) {
+        memcpy(ptr->framebuffer + (firstPage * SSD1306_SEGMENTS), pages, count * sizeof(PAGE));
+        markDirty(ptr, 0, SSD1306_WIDTH-1, firstPage, lastPage);
+        return OK;
+    }
+
+    RESULT ret = sendWindow(ptr, 0, SSD1306_WIDTH-1, firstPage, lastPage, (const uint8_t *)pages, count * sizeof(PAGE));
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdatePages(): Failed to send PAGE[%d-%d]! Error = %d", firstPage, lastPage, ret);
+    }
+
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to place a page-format bitmap with its top-left corner at 
+ * origin. Parts past the right or bottom edge are clipped.
+ *
+ *  INPUT
+ *      bits   - (height+7)/8 pages of width bytes, LSB on top, like PAGE.
+ *      mask   - optional, same layout: only pixels whose mask bit is set are
+ *               touched. NULL touches the whole width x height rectangle.
+ *      op     - how source pixels combine with the display. Without the 
+ *               framebuffer only COPY and OR without a mask are possible,
+ *               and both turn off pixels sharing the rectangle's bytes.
+ *
+ *  NOTE
+ *      Algo: each destination page takes the low bits of one source page
+ *            shifted down and the high bits of the page above, gathered and
+ *            combined four columns per 32-bit word.
+ *      bits and mask are only read with aligned 32-bit loads, so they may
+ *      be in flash, like the fonts.
+ *      Bitmaps are in pages, so they need a 0 or 180 degree rotation.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_Blit(const void *context, const POINT origin, uint8_t width, uint8_t height, 
+             const uint8_t *bits, const uint8_t *mask, SSD1306_BLIT_OP op)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_Blit");
+
+    if (bits == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_Blit(): bits cannot be NULL.");
+        return INVALID_ARGUMENT;
+    }
+
+    if ((op != SSD1306_BLIT_COPY) && (op != SSD1306_BLIT_OR) && (op != SSD1306_BLIT_AND) && (op != SSD1306_BLIT_XOR)) {
+        ESP_LOGE(SSD_TAG, "SSD1306_Blit(): Invalid op %d.", op);
+        return INVALID_ARGUMENT;
+    }
+
+    if ((ptr->framebuffer == NULL) && ((mask != NULL) || (op == SSD1306_BLIT_AND) || (op == SSD1306_BLIT_XOR))) {
+        ESP_LOGE(SSD_TAG, "SSD1306_Blit(): Masks, AND and XOR need the framebuffer enabled.");
+        return NOT_IMPLEMENTED;
+    }
+
+    RESULT ret = checkLandscape(ptr, "SSD1306_Blit");
+    if (ret != OK) {
+        return ret;
+    }
+
+    if ((width == 0) || (height == 0) || (origin.row >= SSD1306_HEIGHT) || (origin.col >= SSD1306_WIDTH)) {
+        return OK;
+    }
+
+    uint8_t srcPages  = (height + 7) / 8;
+    uint8_t lastValid = 0xFF >> ((8 * srcPages) - height);  // rows of the last source page inside height
+    uint8_t shift     = origin.row & 7;
+    uint8_t firstPage = origin.row / 8;
+    uint8_t lastPage  = MIN((origin.row + height - 1) / 8, SSD1306_PAGES-1);
+    uint8_t scol      = origin.col;
+    uint8_t ecol      = MIN(origin.col + width - 1, SSD1306_WIDTH-1);
+
+    // Indexed by destination column, so they share the framebuffer's word alignment.
+    uint8_t src[SSD1306_SEGMENTS] __attribute__((aligned(4)));
+    uint8_t sel[SSD1306_SEGMENTS] __attribute__((aligned(4)));
+
+    LOCK_BUS(ptr);
+    for (uint8_t page = firstPage; (page <= lastPage) && (ret == OK); page++) {
+        // source page whose low bits land here, and the one above it
+        int sp = page - firstPage;
+        bool hasLo = (sp < srcPages);
+        bool hasHi = (shift != 0) && (sp > 0);
+        uint8_t loValid = hasLo ? ((sp == srcPages-1) ? lastValid : 0xFF) : 0;
+        uint8_t hiValid = hasHi ? ((sp-1 == srcPages-1) ? lastValid : 0xFF) : 0;
+        size_t loOffset = sp * width;
+        size_t hiOffset = (sp-1) * width;
+
+        blitGather(src, hasLo ? bits + loOffset : NULL, hasHi ? bits + hiOffset : NULL, 
+                   loValid, hiValid, shift, scol, ecol);
+        if (mask != NULL) {
+            blitGather(sel, hasLo ? mask + loOffset : NULL, hasHi ? mask + hiOffset : NULL, 
+                       loValid, hiValid, shift, scol, ecol);
+        } else {
+            uint8_t rows = (uint8_t)(loValid << shift) | ((shift != 0) ? (hiValid >> (8 - shift)) : 0);
+            memset(sel + scol, rows, ecol - scol + 1);
+        }
+
+        if (ptr->framebuffer != NULL) {
+            blitApply(ptr->framebuffer + (page * SSD1306_SEGMENTS), src, sel, scol, ecol, op);
+            markDirty(ptr, scol, ecol, page, page);
+        } else {
+            ret = sendWindow(ptr, scol, ecol, page, page, src + scol, ecol - scol + 1);
+        }
+    }
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_Blit(): Failed to send bitmap. Error = %d", ret);
+    }
+
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to set the contrast level. A running contrast ramp is 
+ * stopped.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT SSD1306_SetContrast(const void *context, uint8_t contrast)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_SetContrast");
+    
+    LOCK_BUS(ptr);
+    SSD1306_StopContrastRamp(ptr);
+    RESULT ret = setContrast(ptr, contrast);
+    UNLOCK_BUS(ptr);
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to move the contrast to a new level over durationMs, one 
+ * level per step, from a FreeRTOS timer. The caller returns at once and 
+ * each step is a single 2-byte command, so a fade costs neither CPU time 
+ * nor a task busy-calling SSD1306_SetContrast().
+ *
+ *  INPUT
+ *      callback - optional, runs on the timer task when the ramp reaches 
+ *                 contrast or a step fails. It must not block.
+ *
+ *  NOTE
+ *      Steps are at least one tick apart; a short ramp skips levels.
+ *      A ramp already running is replaced without its callback, as is one
+ *      stopped by SSD1306_StopContrastRamp() or SSD1306_SetContrast().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_StartContrastRamp(const void *context, uint8_t contrast, uint32_t durationMs, 
+                          SSD1306_ASYNC_CALLBACK callback, void *arg)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_StartContrastRamp");
+
+    LOCK_BUS(ptr);
+    SSD1306_StopContrastRamp(ptr);
+
+    const TickType_t ticks = pdMS_TO_TICKS(durationMs);
+    const uint16_t   delta = (contrast > ptr->contrast) ? contrast - ptr->contrast : ptr->contrast - contrast;
+    if ((ticks == 0) || (delta == 0)) {
+        RESULT ret = setContrast(ptr, contrast);
+        UNLOCK_BUS(ptr);
+        if (callback != NULL) {
+            callback(arg, ret);
+        }
+        return ret;
+    }
+
+    // Whole ticks between steps, as many steps as fit in the duration.
+    const TickType_t period = (ticks + delta - 1) / delta;
+    const uint16_t   steps  = ticks / period;
+    if (ptr->ramp.timer == NULL) {
+        ptr->ramp.timer = xTimerCreate("ssd1306_ramp", period, pdTRUE, ptr, contrastRampStep);
+        if (ptr->ramp.timer == NULL) {
+            UNLOCK_BUS(ptr);
+            ESP_LOGE(SSD_TAG, "SSD1306_StartContrastRamp(): Failed to create timer.");
+            return FAILED_TO_ALLOCATE_MEMORY;
+        }
+    }
+
+    ptr->ramp.from     = ptr->contrast;
+    ptr->ramp.to       = contrast;
+    ptr->ramp.step     = 0;
+    ptr->ramp.steps    = steps;
+    ptr->ramp.callback = callback;
+    ptr->ramp.arg      = arg;
+    ptr->ramp.active   = true;
+    UNLOCK_BUS(ptr);
+
+    // Changing the period also (re)starts the timer.
+    if (xTimerChangePeriod(ptr->ramp.timer, period, portMAX_DELAY) != pdPASS) {
+        SSD1306_StopContrastRamp(ptr);
+        ESP_LOGE(SSD_TAG, "SSD1306_StartContrastRamp(): Failed to start timer.");
+        return FAILED_TO_CREATE_TASK;
+    }
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to stop a contrast ramp where it is. Its callback is not 
+ * called.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_StopContrastRamp(const void *context)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_StopContrastRamp");
+
+    LOCK_BUS(ptr);
+    if (ptr->ramp.active) {
+        ptr->ramp.active = false;                   // a step already due does nothing
+        xTimerStop(ptr->ramp.timer, 0);
+    }
+    UNLOCK_BUS(ptr);
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to let the controller fade out or blink the display on its
+ * own, until called again with SSD1306_FADE_DISABLED.
+ *
+ *  INPUT
+ *      frames - frames per contrast step, 8 to 128 in multiples of 8. 
+ *               Ignored for SSD1306_FADE_DISABLED.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_SetFade(const void *context, SSD1306_FADE fade, uint8_t frames)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_SetFade");
+
+    if (fade == SSD1306_FADE_DISABLED) {
+        const uint8_t cmds[] = { SSD1306_SET_FADE_OUT_AND_BLINK, SSD1306_FADE_DISABLED };
+        return sendCommands(ptr, cmds, sizeof(cmds));
+    }
+
+    if (((fade != SSD1306_FADE_OUT) && (fade != SSD1306_FADE_BLINK)) ||
+        (frames < 8) || (frames > 128) || ((frames & 7) != 0)) {
+        ESP_LOGE(SSD_TAG, "SSD1306_SetFade(): Invalid fade, frames must be 8 to 128 in steps of 8.");
+        return INVALID_ARGUMENT;
+    }
+
+    const uint8_t cmds[] = { SSD1306_SET_FADE_OUT_AND_BLINK, (uint8_t)fade | ((frames / 8) - 1) };
+    return sendCommands(ptr, cmds, sizeof(cmds));
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to show GDDRAM inverted, lit pixels off. GDDRAM and the 
+ * framebuffer are unchanged.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_SetInverted(const void *context, bool inverted)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_SetInverted");
+
+    const uint8_t cmd = inverted ? SSD1306_SET_INVERSE_DISPLAY : SSD1306_SET_NORMAL_DISPLAY;
+    return sendCommands(ptr, &cmd, 1);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to light every pixel regardless of GDDRAM, e.g. to flash an
+ * alert. Turning it off shows GDDRAM again, no redraw needed.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_SetEntireDisplayOn(const void *context, bool on)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_SetEntireDisplayOn");
+
+    const uint8_t cmd = on ? SSD1306_DISPLAY_ON_IGNORE_RAM : SSD1306_DISPLAY_ON_FOLLOW_RAM;
+    return sendCommands(ptr, &cmd, 1);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to double the height of every row: the top half of the 
+ * display fills the panel.
+ *
+ *  NOTE
+ *      Needs the alternative COM pin configuration, which initializeDisplay()
+ *      sets for the 128x64 panel.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_SetZoom(const void *context, bool zoom)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_SetZoom");
+
+    const uint8_t cmds[] = { SSD1306_SET_ZOOM_IN, zoom ? 0x01 : 0x00 };
+    return sendCommands(ptr, cmds, sizeof(cmds));
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to rotate or mirror the picture in the controller, by 
+ * reprogramming the segment remap and the COM scan direction, so frames are
+ * never flipped in software.
+ *
+ *  INPUT
+ *      mirrorX - flip left to right, after rotating.
+ *      mirrorY - flip top to bottom, after rotating.
+ *
+ *  NOTE
+ *      The COM scan direction applies at once, the segment remap only to 
+ *      data written after it. When the remap changes, the framebuffer, if 
+ *      enabled, is rewritten; otherwise redraw the display.
+ *      90 and 270 degrees make the display 64x128: send frames with 
+ *      SSD1306_UpdatePortrait(). Pixels, lines, rectangles and circles take
+ *      portrait coordinates; the framebuffer stays in GDDRAM order, which 
+ *      is the portrait picture transposed, so it flushes as it is. Text, 
+ *      bitmaps and the console are laid out in pages and are rejected.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_SetRotation(const void *context, SSD1306_ROTATION rotation, bool mirrorX, bool mirrorY)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_SetRotation");
+
+    if ((uint32_t)rotation > SSD1306_ROTATE_270) {
+        ESP_LOGE(SSD_TAG, "SSD1306_SetRotation(): Invalid rotation %d.", rotation);
+        return INVALID_ARGUMENT;
+    }
+
+    // Portrait frames are sent transposed, column address = portrait row, so 
+    // flipping the segments flips portrait rows and flipping COMs flips 
+    // portrait columns. A transpose is a 90 degree turn plus one flip.
+    const bool portrait = (rotation == SSD1306_ROTATE_90) || (rotation == SSD1306_ROTATE_270);
+    bool flipSegments = (rotation == SSD1306_ROTATE_90) || (rotation == SSD1306_ROTATE_180);
+    bool flipComs     = (rotation == SSD1306_ROTATE_180) || (rotation == SSD1306_ROTATE_270);
+    flipSegments ^= portrait ? mirrorY : mirrorX;
+    flipComs     ^= portrait ? mirrorX : mirrorY;
+
+    const uint8_t cmds[] = {
+        flipSegments ? SSD1306_SET_SEGMENT_REMAP_COL_TO_0 : SSD1306_SET_SEGMENT_REMAP_COL_TO_127,
+        flipComs ? SSD1306_SET_COM_OUTPUT_SCAN_REMAPPED : SSD1306_SET_COM_OUTPUT_SCAN__NORMAL
+    };
+
+    LOCK_BUS(ptr);
+    const bool remapped = (cmds[0] != ptr->segmentRemap);
+    RESULT ret = sendCommands(ptr, cmds, sizeof(cmds));
+    if (ret == OK) {
+        ptr->segmentRemap = cmds[0];
+        ptr->comScan      = cmds[1];
+        ptr->rotation     = rotation;
+    }
+    if ((ret == OK) && remapped && (ptr->framebuffer != NULL)) {
+        ret = flushWindow(ptr, 0, SSD1306_WIDTH-1, 0, SSD1306_PAGES-1);
+        if (ret == OK) {
+            markClean(ptr);
+        }
+    }
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_SetRotation(): Failed to set rotation. Error = %d.", ret);
+    }
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to send a full portrait frame, see SSD1306_SetRotation().
+ *
+ *  INPUT
+ *      rows - SSD1306_PORTRAIT_HEIGHT rows of 
+ *             SSD1306_ROW_STRIDE(SSD1306_PORTRAIT_WIDTH) bytes, LSB on the 
+ *             left.
+ *
+ *  NOTE
+ *      In vertical addressing mode GDDRAM fills a column at a time, page 0 
+ *      to 7, which is the order of a portrait row's bytes. The frame is 
+ *      streamed as it is, no transpose. The framebuffer, if enabled, is 
+ *      updated to match.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_UpdatePortrait(const void *context, const uint8_t *rows)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_UpdatePortrait");
+
+    if (rows == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdatePortrait(): rows cannot be NULL.");
+        return INVALID_ARGUMENT;
+    }
+
+    if (!isPortrait(ptr)) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdatePortrait(): Needs a 90 or 270 degree rotation.");
+        return INVALID_STATE_CHANGE_REQUEST;
+    }
+
+    const I2C_BUFFER buffer = { rows, SSD1306_FRAMEBUFFER_SIZE };
+    LOCK_BUS(ptr);
+    RESULT ret = sendModeWindowBuffers(ptr, SSD1306_VERTICAL_ADDRESSING_MODE, 0, SSD1306_WIDTH-1, 
+                                       0, SSD1306_PAGES-1, &buffer, 1);
+    if ((ret == OK) && (ptr->framebuffer != NULL)) {
+        for (uint8_t col=0; col<SSD1306_WIDTH; col++) {
+            for (uint8_t page=0; page<SSD1306_PAGES; page++) {
+                ptr->framebuffer[(page * SSD1306_SEGMENTS) + col] = rows[(col * SSD1306_PAGES) + page];
+            }
+        }
+        markClean(ptr);
+    }
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdatePortrait(): Failed to send frame. Error = %d.", ret);
+    }
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to start continuous hardware scrolling. The controller moves
+ * the picture on its own, so a ticker costs one command list rather than
+ * its region resent every frame.
+ *
+ *  NOTE
+ *      Horizontal scrolling rotates the GDDRAM of startPage-endPage in 
+ *      place; with a verticalOffset the rows of the vertical scroll area
+ *      also move up, by moving the display start line.
+ *      A scroll already running is stopped first, see SSD1306_StopScroll().
+ *      Writes to scrolling pages land in RAM that keeps moving. Draw into
+ *      the framebuffer instead and let SSD1306_StopScroll() put the pages 
+ *      back in place.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_StartScroll(const void *context, const SSD1306_SCROLL *scroll)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_StartScroll");
+
+    if ((scroll == NULL) || (scroll->startPage > scroll->endPage) || (scroll->endPage >= SSD1306_PAGES) ||
+        ((uint32_t)scroll->speed > SSD1306_SCROLL_2_FRAMES) || ((uint32_t)scroll->direction > SSD1306_SCROLL_LEFT)) {
+        ESP_LOGE(SSD_TAG, "SSD1306_StartScroll(): Invalid scroll, need startPage <= endPage < %d.", SSD1306_PAGES);
+        return INVALID_ARGUMENT;
+    }
+
+    const bool    vertical   = (scroll->verticalOffset > 0);
+    const uint8_t scrollRows = (scroll->scrollRows > 0) ? scroll->scrollRows : SSD1306_HEIGHT - scroll->fixedRows;
+    if (vertical && ((scroll->fixedRows + scrollRows > SSD1306_HEIGHT) || (scroll->verticalOffset >= scrollRows))) {
+        ESP_LOGE(SSD_TAG, "SSD1306_StartScroll(): Vertical area must fit the display and exceed the offset. "
+                          "fixed=%d, rows=%d, offset=%d.", scroll->fixedRows, scrollRows, scroll->verticalOffset);
+        return INVALID_ARGUMENT;
+    }
+
+    // Setup must be sent with scrolling deactivated.
+    uint8_t cmds[13];
+    size_t  count = 0;
+    cmds[count++] = SSD1306_DEACTIVATE_SCROLL;
+    if (vertical) {
+        cmds[count++] = SSD1306_SET_VERTICAL_SCROLL_AREA;
+        cmds[count++] = scroll->fixedRows;
+        cmds[count++] = scrollRows;
+        cmds[count++] = (scroll->direction == SSD1306_SCROLL_RIGHT) ? SSD1306_VERTICAL_RIGHT_HORIZONTAL_SCROLL
+                                                                    : SSD1306_VERTICAL_LEFT_HORIZONTAL_SCROLL;
+    } else {
+        cmds[count++] = (scroll->direction == SSD1306_SCROLL_RIGHT) ? SSD1306_RIGHT_HORIZONTAL_SCROLL
+                                                                    : SSD1306_LEFT_HORIZONTAL_SCROLL;
+    }
+    cmds[count++] = 0x00;                                               // dummy
+    cmds[count++] = scroll->startPage;
+    cmds[count++] = (uint8_t)scroll->speed;
+    cmds[count++] = scroll->endPage;
+    if (vertical) {
+        cmds[count++] = scroll->verticalOffset;
+    } else {
+        cmds[count++] = 0x00;                                           // dummy
+        cmds[count++] = 0xFF;                                           // dummy
+    }
+    cmds[count++] = SSD1306_ACTIVATE_SCROLL;
+
+    LOCK_BUS(ptr);
+    RESULT ret = ptr->scroll.active ? stopScroll(ptr) : OK;
+    if (ret == OK) {
+        ret = sendCommands(ptr, cmds, count);
+    }
+    if (ret == OK) {
+        ptr->scroll.active   = true;
+        ptr->scroll.vertical = vertical;
+        ptr->scroll.spage    = scroll->startPage;
+        ptr->scroll.epage    = scroll->endPage;
+    }
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_StartScroll(): Failed to start scrolling. Error = %d.", ret);
+    }
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to stop hardware scrolling.
+ *
+ *  NOTE
+ *      The controller leaves the scrolled pages wherever the last step put
+ *      them. With the framebuffer enabled they are rewritten from it, so
+ *      the display matches the framebuffer again; without it the caller
+ *      has to redraw them.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_StopScroll(const void *context)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_StopScroll");
+
+    LOCK_BUS(ptr);
+    RESULT ret = stopScroll(ptr);
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_StopScroll(): Failed to stop scrolling. Error = %d.", ret);
+    }
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to change the I2C bus-speed profile. Transports without 
+ * profiles return NOT_IMPLEMENTED.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_SetBusSpeed(const void *context, I2C_BUS_SPEED speed)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_SetBusSpeed");
+
+    LOCK_BUS(ptr);
+    RESULT ret = ptr->transport->setBusSpeed(ptr->link, speed);
+    UNLOCK_BUS(ptr);
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to enable or disable the shadow framebuffer.
+ *
+ *  NOTE
+ *      While enabled the draw methods only update the shadow copy of GDDRAM
+ *      and record which columns of each page changed. SSD1306_Flush() must
+ *      be called to send the changes to the display.
+ *      Enabling marks the whole display dirty so that the first flush brings
+ *      the display in line with the (cleared) framebuffer.
+ *      Disabling discards any changes that have not been flushed.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_EnableFramebuffer(const void *context, bool enable)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_EnableFramebuffer");
+
+    if (!enable) {
+        free(ptr->framebuffer);
+        ptr->framebuffer = NULL;
+        markClean(ptr);
+        return OK;
+    }
+
+    if (ptr->framebuffer != NULL) {
+        return OK;
+    }
+
+    ptr->framebuffer = (uint8_t *)calloc(SSD1306_FRAMEBUFFER_SIZE, 1);
+    if (ptr->framebuffer == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_EnableFramebuffer(): Failed to allocate memory for framebuffer!");
+        return FAILED_TO_ALLOCATE_MEMORY;
+    }
+
+    markDirty(ptr, 0, SSD1306_WIDTH-1, 0, SSD1306_PAGES-1);
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to send the dirty regions of the framebuffer to the display.
+ *
+ *  NOTE
+ *      See nextDirtyWindow() for how dirty pages are grouped into windows.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_Flush(const void *context)
+{
+    PERF_API_SCOPE(PERF_FLUSH);
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_Flush");
+
+    if (ptr->framebuffer == NULL) {
+        return OK;                                      // nothing is buffered, draw methods write through.
+    }
+
+    uint8_t scol, ecol, spage, epage;
+    uint8_t page = 0;
+    while (nextDirtyWindow(ptr, page, &scol, &ecol, &spage, &epage)) {
+        RESULT ret = flushWindow(ptr, scol, ecol, spage, epage);
+        if (ret != OK) {
+            ESP_LOGE(SSD_TAG, "SSD1306_Flush(): Failed to send PAGES[%d-%d]. Error = %d.", spage, epage, ret);
+            return ret;
+        }
+
+        for (uint8_t x=spage; x<=epage; x++) {
+            ptr->dirtyStart[x] = 0xFF;
+            ptr->dirtyEnd[x]   = 0x00;
+        }
+        page = epage + 1;
+    }
+
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to copy the framebuffer out as a row-major 1bpp image.
+ *
+ *  INPUT
+ *      rows   - receives SSD1306_HEIGHT rows of SSD1306_ROW_STRIDE(SSD1306_WIDTH)
+ *               bytes, LSB on the left, see SSD1306_PagesToRows().
+ *
+ *  NOTE
+ *      Needs the framebuffer; GDDRAM cannot be read back over the bus.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_Screenshot(const void *context, uint8_t *rows)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_Screenshot");
+
+    if (ptr->framebuffer == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_Screenshot(): Needs the framebuffer enabled.");
+        return NOT_IMPLEMENTED;
+    }
+
+    LOCK_BUS(ptr);
+    RESULT ret = SSD1306_PagesToRows(ptr->framebuffer, SSD1306_WIDTH, SSD1306_HEIGHT, rows);
+    UNLOCK_BUS(ptr);
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to send a full frame to each panel of a lane context.
+ *
+ *  INPUT
+ *      frames - laneCount pointers to SSD1306_WIDTH*SSD1306_HEIGHT/8 bytes
+ *               in GDDRAM order (page 0 columns 0-127, page 1, ...).
+ *
+ *  NOTE
+ *      Byte x of every frame is clocked out by the same SCL pulses, so all 
+ *      panels are refreshed in the time a single panel takes. The framebuffer,
+ *      if enabled, is not updated.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_UpdateLanes(const void *context, const uint8_t *const *frames)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_UpdateLanes");
+
+    if (frames == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdateLanes(): frames cannot be NULL.");
+        return INVALID_ARGUMENT;
+    }
+
+    if (ptr->transport != &SSD1306_I2C_TRANSPORT) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdateLanes(): Lanes need the I2C transport, not %s.", ptr->transport->name);
+        return NOT_IMPLEMENTED;
+    }
+
+    // Window commands, if any, ride in the data transaction's prefix.
+    uint8_t cmds[SSD1306_WINDOW_COMMANDS];
+    uint8_t prefix[(2 * SSD1306_WINDOW_COMMANDS) + 1];
+    LOCK_BUS(ptr);
+    RESULT ret = setAddressingMode(ptr, SSD1306_HORIZONTAL_ADDRESSING_MODE);
+    size_t cmdCount = windowCommands(ptr, 0, SSD1306_WIDTH-1, 0, SSD1306_PAGES-1, SSD1306_FRAMEBUFFER_SIZE, cmds);
+    if (ret != OK) {
+        cmdCount = 0;
+    } else if (cmdCount > SSD1306_MIXED_MAX_COMMANDS) {
+        ret = setWriteLocation(ptr, cmds, cmdCount);
+        cmdCount = 0;
+    } else if (cmdCount > 0) {
+        ptr->windowStats.mixed++;
+    }
+    if (ret == OK) {
+        ret = I2C_StartXmit(ptr->link);
+    }
+    uint32_t nackLanes = 0;
+    if (ret == OK) {
+        ret = I2C_WriteBuffer(ptr->link, prefix, i2cCommandPrefix(cmds, cmdCount, prefix), NULL);
+    }
+    if (ret == OK) {
+        ret = I2C_WriteLanes(ptr->link, frames, SSD1306_FRAMEBUFFER_SIZE, &nackLanes);
+    }
+    I2C_StopXmit(ptr->link);
+    if (ret == OK) {
+        commitWindow(ptr, cmds, cmdCount);
+        advanceCursor(ptr, SSD1306_FRAMEBUFFER_SIZE);
+    } else {
+        ptr->cursor.valid = false;
+    }
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdateLanes(): Failed to send frames, NACK'd lanes=0x%x. Error = %d.", nackLanes, ret);
+    }
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to start async mode.
+ *
+ *  A dedicated transmit task takes over sending framebuffer regions to the
+ *  display. Callers keep drawing into the framebuffer (enabled here if it is
+ *  not already) and queue regions with SSD1306_UpdateRegionAsync() or 
+ *  SSD1306_FlushAsync(), which return as soon as the region is queued.
+ *
+ *  INPUT
+ *      priority - FreeRTOS priority of the transmit task.
+ *
+ *  NOTE
+ *      The task reads the framebuffer when it sends a region, not when the
+ *      region is queued. A request for a region already covered by a queued
+ *      request is therefore merged into it instead of being queued again.
+ *      Synchronous methods remain usable, bus access is serialized by busLock.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_StartAsync(const void *context, UBaseType_t priority)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_StartAsync");
+
+    if (ptr->async != NULL) {
+        return OK;
+    }
+
+    RESULT ret = SSD1306_EnableFramebuffer(ptr, true);
+    if (ret != OK) {
+        return ret;
+    }
+
+    ssd1306_async_t *async = (ssd1306_async_t *)calloc(1, sizeof(ssd1306_async_t));
+    if (async == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_StartAsync(): Failed to allocate memory for async state!");
+        return FAILED_TO_ALLOCATE_MEMORY;
+    }
+
+    async->queue     = xQueueCreate(SSD1306_ASYNC_QUEUE_DEPTH+1, sizeof(uint8_t));   // +1 for SSD1306_ASYNC_STOP
+    async->freeSlots = xQueueCreate(SSD1306_ASYNC_QUEUE_DEPTH, sizeof(uint8_t));
+    async->lock      = xSemaphoreCreateMutex();
+    async->stopped   = xSemaphoreCreateBinary();
+    if ((async->queue == NULL) || (async->freeSlots == NULL) || (async->lock == NULL) || (async->stopped == NULL)) {
+        ESP_LOGE(SSD_TAG, "SSD1306_StartAsync(): Failed to allocate queues!");
+        ret = FAILED_TO_ALLOCATE_MEMORY;
+    }
+
+    for (uint8_t x=0; (ret == OK) && (x<SSD1306_ASYNC_QUEUE_DEPTH); x++) {
+        xQueueSend(async->freeSlots, &x, 0);
+    }
+
+    ptr->async = async;
+    if ((ret == OK) && 
+        (xTaskCreate(asyncTransmitTask, "ssd1306_tx", SSD1306_ASYNC_STACK_SIZE, ptr, priority, &async->task) != pdPASS)) {
+        ESP_LOGE(SSD_TAG, "SSD1306_StartAsync(): Failed to create transmit task!");
+        ret = FAILED_TO_CREATE_TASK;
+    }
+
+    if (ret != OK) {
+        ptr->async = NULL;
+        if (async->queue)     vQueueDelete(async->queue);
+        if (async->freeSlots) vQueueDelete(async->freeSlots);
+        if (async->lock)      vSemaphoreDelete(async->lock);
+        if (async->stopped)   vSemaphoreDelete(async->stopped);
+        free(async);
+    }
+
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to stop async mode. Requests already queued are sent and 
+ * their callbacks run before the transmit task exits.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_StopAsync(const void *context)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_StopAsync");
+
+    ssd1306_async_t *async = ptr->async;
+    if (async == NULL) {
+        return OK;
+    }
+
+    const uint8_t stop = SSD1306_ASYNC_STOP;
+    xQueueSend(async->queue, &stop, portMAX_DELAY);
+    xSemaphoreTake(async->stopped, portMAX_DELAY);
+
+    ptr->async = NULL;
+    while (async->waiters != NULL) {                    // only possible for tickets that never completed
+        async_waiter_t *next = async->waiters->next;
+        free(async->waiters);
+        async->waiters = next;
+    }
+    vQueueDelete(async->queue);
+    vQueueDelete(async->freeSlots);
+    vSemaphoreDelete(async->lock);
+    vSemaphoreDelete(async->stopped);
+    free(async);
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to queue a framebuffer region for the transmit task.
+ *
+ *  INPUT
+ *      scol, ecol   - column range, inclusive.
+ *      spage, epage - page range, inclusive.
+ *      callback     - optional. Called from the transmit task once the region
+ *                     has been sent.
+ *      arg          - passed to callback.
+ *
+ *  NOTE
+ *      Blocks only while all SSD1306_ASYNC_QUEUE_DEPTH slots are in use.
+ *      Does not touch the dirty ranges used by SSD1306_Flush().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_UpdateRegionAsync(const void *context, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage,
+                          SSD1306_ASYNC_CALLBACK callback, void *arg)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_UpdateRegionAsync");
+
+    if (ptr->async == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdateRegionAsync(): Async mode not started.");
+        return INVALID_ARGUMENT;
+    }
+
+    if ((scol > ecol) || (ecol >= SSD1306_WIDTH) || (spage > epage) || (epage >= SSD1306_PAGES)) {
+        ESP_LOGE(SSD_TAG, "SSD1306_UpdateRegionAsync(): Invalid region cols[%d-%d] pages[%d-%d].", 
+                            scol, ecol, spage, epage);
+        return COORDINATE_OUT_OF_RANGE;
+    }
+
+    uint32_t ticket;
+    return enqueueRegion(ptr, scol, ecol, spage, epage, ptr->async->completedSequence, callback, arg, &ticket);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to queue every dirty region of the framebuffer for the 
+ * transmit task and mark the framebuffer clean. Async counterpart of
+ * SSD1306_Flush().
+ *
+ *  NOTE
+ *      callback runs once, after the last of the queued regions was sent. 
+ *      If nothing is dirty it runs immediately from the calling task.
+ *      Regions that could not be queued are left dirty, and callback does
+ *      not run.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_FlushAsync(const void *context, SSD1306_ASYNC_CALLBACK callback, void *arg)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_FlushAsync");
+
+    if (ptr->async == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_FlushAsync(): Async mode not started.");
+        return INVALID_ARGUMENT;
+    }
+
+    uint8_t wscol[SSD1306_PAGES], wecol[SSD1306_PAGES], wspage[SSD1306_PAGES], wepage[SSD1306_PAGES];
+    uint8_t windows = 0, page = 0;
+    while (nextDirtyWindow(ptr, page, &wscol[windows], &wecol[windows], &wspage[windows], &wepage[windows])) {
+        page = wepage[windows] + 1;
+        windows++;
+    }
+    markClean(ptr);
+
+    if (windows == 0) {
+        if (callback != NULL) {
+            callback(arg, OK);
+        }
+        return OK;
+    }
+
+    // callback goes on the last window and waits for the highest ticket, since
+    // an earlier window may have been merged into a request queued later.
+    uint32_t ticket = ptr->async->completedSequence;
+    for (uint8_t x=0; x<windows; x++) {
+        bool last = (x == windows-1);
+        RESULT ret = enqueueRegion(ptr, wscol[x], wecol[x], wspage[x], wepage[x], ticket,
+                                   last ? callback : NULL, arg, &ticket);
+        if (ret != OK) {
+            // only what was queued is clean, the rest waits for the next flush
+            for (; x<windows; x++) {
+                markDirty(ptr, wscol[x], wecol[x], wspage[x], wepage[x]);
+            }
+            ESP_LOGE(SSD_TAG, "SSD1306_FlushAsync(): Failed to queue regions. Error = %d.", ret);
+            return ret;
+        }
+    }
+
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to read the async queue depth and transmit latency counters.
+ * Latencies are measured from the time a region is first queued to the time
+ * it has been sent.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_GetAsyncStats(const void *context, SSD1306_ASYNC_STATS *stats)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_GetAsyncStats");
+
+    if ((ptr->async == NULL) || (stats == NULL)) {
+        return INVALID_ARGUMENT;
+    }
+
+    xSemaphoreTake(ptr->async->lock, portMAX_DELAY);
+    *stats = ptr->async->stats;
+    xSemaphoreGive(ptr->async->lock);
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to read how much address window setup SSD1306_TRACK_CURSOR
+ * and SSD1306_ADAPTIVE_ADDRESSING avoided.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_GetWindowStats(const void *context, SSD1306_WINDOW_STATS *stats)
+{
+    ssd1306_t *ptr;
+    ASSIGN_CONTEXT(ptr, context, "SSD1306_GetWindowStats");
+
+    if (stats == NULL) {
+        return INVALID_ARGUMENT;
+    }
+
+    LOCK_BUS(ptr);
+    *stats = ptr->windowStats;
+    UNLOCK_BUS(ptr);
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
  * Private method to configure the ssd1306 display.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 static RESULT 
@@ -503,30 +2091,28 @@ initializeDisplay(ssd1306_t *ptr, uint8_t contrast)
     ESP_LOGD(SSD_TAG, "initializeDisplay(): called to configure display.");
     #endif
 
-    RESULT ret;
-    I2C_StartXmit(ptr->i2c);
-
-    SSD1306_SEND_CMD(ptr, SSD1306_COMMAND_MULTI_BYTE, ret);             
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_MULTIPLEX_RATIO, ret);
-    SSD1306_SEND_CMD(ptr, 0x3F, ret);                                   // RESET value: 63 maps to 64MUX
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_MEMORY_ADDRESSING_MODE, ret);
-    SSD1306_SEND_CMD(ptr, SSD1306_DEFAULT_ADDRESSING_MODE, ret);           
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_DISPLAY_OFFSET, ret);
-    SSD1306_SEND_CMD(ptr, 0x00, ret);                                   // display offset
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_DISPLAY_START_LINE, ret);
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_SEGMENT_REMAP_COL_TO_127, ret);
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_COM_OUTPUT_SCAN__NORMAL, ret);    // Set COM output scan direction
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_COM_PINS_HW_CONFIGURATION, ret);
-    SSD1306_SEND_CMD(ptr, 0x12, ret);                                   // COM Hardware Configuration (128x64)
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_CONTRAST, ret);
-    SSD1306_SEND_CMD(ptr, contrast, ret);
-    SSD1306_SEND_CMD(ptr, SSD1306_DISPLAY_ON_FOLLOW_RAM, ret);
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_NORMAL_DISPLAY, ret);
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_DCLCK_DIV_RATION_FOSC, ret);
-    SSD1306_SEND_CMD(ptr, 0x80, ret);                                   // RESET values: divide ratio=1, Fosc=8
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_CHARGE_PUMP, ret);
-    SSD1306_SEND_CMD(ptr, 0x14, ret);                                   // Internal DC/DC
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_DISPLAY_ON, ret);
+    const uint8_t cmds[] = {
+        SSD1306_SET_MULTIPLEX_RATIO,
+        0x3F,                                                           // RESET value: 63 maps to 64MUX
+        SSD1306_SET_MEMORY_ADDRESSING_MODE,
+        SSD1306_DEFAULT_ADDRESSING_MODE,
+        SSD1306_SET_DISPLAY_OFFSET,
+        0x00,                                                           // display offset
+        SSD1306_SET_DISPLAY_START_LINE,
+        SSD1306_SET_SEGMENT_REMAP_COL_TO_127,
+        SSD1306_SET_COM_OUTPUT_SCAN__NORMAL,                            // Set COM output scan direction
+        SSD1306_SET_COM_PINS_HW_CONFIGURATION,
+        0x12,                                                           // COM Hardware Configuration (128x64)
+        SSD1306_SET_CONTRAST,
+        contrast,
+        SSD1306_DISPLAY_ON_FOLLOW_RAM,
+        SSD1306_SET_NORMAL_DISPLAY,
+        SSD1306_SET_DCLCK_DIV_RATION_FOSC,
+        0x80,                                                           // RESET values: divide ratio=1, Fosc=8
+        SSD1306_SET_CHARGE_PUMP,
+        0x14,                                                           // Internal DC/DC
+        SSD1306_SET_DISPLAY_ON
+    };
 
 #if 0
     SSD1306_SEND_CMD(ptr, SSD1306_COMMAND_MULTI_BYTE, ret);             // send control byte - command stream
@@ -555,46 +2141,932 @@ initializeDisplay(ssd1306_t *ptr, uint8_t contrast)
     SSD1306_SEND_CMD(ptr, SSD1306_SET_DISPLAY_ON, ret);
 #endif
 
-    I2C_StopXmit(ptr->i2c);
+    return sendCommands(ptr, cmds, sizeof(cmds));
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to send a list of commands to the ssd1306 display in a
+ * single transaction.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+sendCommands(ssd1306_t *ptr, const uint8_t *cmds, size_t length) 
+{
+    LOCK_BUS(ptr);
+    RESULT ret = ptr->transport->sendCommands(ptr->link, cmds, length);
+    if (ret != OK) {
+        ptr->cursor.valid = false;                  // a partial list may have moved the pointer
+    }
+    UNLOCK_BUS(ptr);
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to stream a list of data buffers to GDDRAM in a single 
+ * transaction.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+sendDataBuffers(ssd1306_t *ptr, const I2C_BUFFER *buffers, size_t count) 
+{
+    LOCK_BUS(ptr);
+    RESULT ret = ptr->transport->sendData(ptr->link, buffers, count);
+    if (ret == OK) {
+        size_t length = 0;
+        for (size_t x=0; x<count; x++) {
+            length += buffers[x].length;
+        }
+        advanceCursor(ptr, length);
+    } else {
+        ptr->cursor.valid = false;
+    }
+    UNLOCK_BUS(ptr);
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to send window setup commands followed by data in a single
+ * transaction, see SSD1306_TRANSPORT.sendCommandsAndData.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+sendCommandsAndData(ssd1306_t *ptr, const uint8_t *cmds, size_t length, const I2C_BUFFER *buffers, size_t count) 
+{
+    LOCK_BUS(ptr);
+    RESULT ret = ptr->transport->sendCommandsAndData(ptr->link, cmds, length, buffers, count);
+    if (ret == OK) {
+        size_t dataLength = 0;
+        for (size_t x=0; x<count; x++) {
+            dataLength += buffers[x].length;
+        }
+        commitWindow(ptr, cmds, length);
+        advanceCursor(ptr, dataLength);
+    } else {
+        ptr->cursor.valid = false;
+    }
+    UNLOCK_BUS(ptr);
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * I2C transport. A single control byte with Continuation bit set to 0 
+ * precedes each list, so every following byte is interpreted as a command
+ * (CONTROL_COMMAND_STREAM) or as GDDRAM data (CONTROL_DATA_STREAM).
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+i2cSendCommands(void *link, const uint8_t *cmds, size_t length) 
+{
+    const I2C_BUFFER buffers[] = {
+        { &CONTROL_COMMAND_STREAM, 1 },
+        { cmds, length }
+    };
+
+    RESULT ret = I2C_StartXmit(link);
+    if (ret == OK) {
+        size_t nackOffset;
+        ret = I2C_WriteBuffers(link, buffers, 2, &nackOffset);
+        if (ret != OK) {
+            ESP_LOGE(SSD_TAG, "sendCommands(): Failed to send command: 0x%x! Error = %d", 
+                                (nackOffset > 0) ? cmds[nackOffset-1] : CONTROL_COMMAND_STREAM, ret);
+        }
+    }
+
+    I2C_StopXmit(link);
+    return ret;
+}
+
+static RESULT
+i2cSendData(void *link, const I2C_BUFFER *buffers, size_t count) 
+{
+    RESULT ret = I2C_StartXmit(link);
+    if (ret == OK) {
+        size_t nackOffset;
+        ret = I2C_WriteBuffer(link, &CONTROL_DATA_STREAM, 1, &nackOffset);
+        if (ret == OK) {
+            ret = I2C_WriteBuffers(link, buffers, count, &nackOffset);
+        }
+        if (ret != OK) {
+            ESP_LOGE(SSD_TAG, "sendDataBuffers(): Slave NACK'd data stream at offset %u. Error = %d", (unsigned)nackOffset, ret);
+        }
+    }
+
+    I2C_StopXmit(link);
+    return ret;
+}
+
+static RESULT
+i2cSendCommandsAndData(void *link, const uint8_t *cmds, size_t length, const I2C_BUFFER *buffers, size_t count) 
+{
+    uint8_t prefix[(2 * SSD1306_WINDOW_COMMANDS) + 1];
+    if (length > SSD1306_WINDOW_COMMANDS) {
+        RESULT ret = i2cSendCommands(link, cmds, length);
+        return (ret == OK) ? i2cSendData(link, buffers, count) : ret;
+    }
+
+    RESULT ret = I2C_StartXmit(link);
+    if (ret == OK) {
+        size_t nackOffset;
+        ret = I2C_WriteBuffer(link, prefix, i2cCommandPrefix(cmds, length, prefix), &nackOffset);
+        if (ret != OK) {
+            ESP_LOGE(SSD_TAG, "sendCommandsAndData(): Slave NACK'd command prefix at offset %u. Error = %d", 
+                                (unsigned)nackOffset, ret);
+        } else {
+            ret = I2C_WriteBuffers(link, buffers, count, &nackOffset);
+            if (ret != OK) {
+                ESP_LOGE(SSD_TAG, "sendCommandsAndData(): Slave NACK'd data stream at offset %u. Error = %d", 
+                                    (unsigned)nackOffset, ret);
+            }
+        }
+    }
+
+    I2C_StopXmit(link);
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to encode commands for a mixed transaction: a Co=1 control
+ * byte before each command byte, then the control byte that starts the data 
+ * stream. prefix must hold 2*length+1 bytes. Returns the bytes written.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static size_t
+i2cCommandPrefix(const uint8_t *cmds, size_t length, uint8_t *prefix)
+{
+    size_t count = 0;
+    for (size_t x=0; x<length; x++) {
+        prefix[count++] = SSD1306_COMMAND_SINGLE_BYTE;
+        prefix[count++] = cmds[x];
+    }
+    prefix[count++] = CONTROL_DATA_STREAM;
+    return count;
+}
+
+static RESULT
+i2cSetBusSpeed(void *link, I2C_BUS_SPEED speed)
+{
+    return I2C_SetBusSpeed(link, speed);
+}
+
+static RESULT
+i2cFreeLink(void **link)
+{
+    return I2C_FreeContext(link);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to allocate the display context around an open transport 
+ * and configure the panel. Frees link on failure.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+createContext(const SSD1306_TRANSPORT *transport, void *link, uint8_t laneCount, uint8_t contrast, void **context)
+{
+    ssd1306_t *ptr = (ssd1306_t *)malloc(sizeof(ssd1306_t));
+    if (ptr == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_Initialize(): Failed to allocate memory for display context!");
+        transport->freeLink(&link);
+        return FAILED_TO_ALLOCATE_MEMORY;    
+    }
+
+    ptr->busLock = xSemaphoreCreateRecursiveMutex();
+    if (ptr->busLock == NULL) {
+        ESP_LOGE(SSD_TAG, "SSD1306_Initialize(): Failed to allocate bus lock!");
+        transport->freeLink(&link);
+        free(ptr);
+        return FAILED_TO_ALLOCATE_MEMORY;    
+    }
+
+    ptr->header      = (uint32_t)ptr;
+    ptr->transport   = transport;
+    ptr->link        = link;
+    ptr->laneCount   = laneCount;
+    ptr->async       = NULL;
+    ptr->glyphs      = NULL;
+    ptr->framebuffer = NULL;
+    ptr->cursor.valid = false;
+    ptr->scroll.active = false;
+    ptr->console.font  = NULL;
+    ptr->startLine     = 0;
+    ptr->contrast      = contrast;
+    ptr->addressingMode = SSD1306_DEFAULT_ADDRESSING_MODE;
+    ptr->modeCredit    = 0;
+    ptr->segmentRemap  = SSD1306_SET_SEGMENT_REMAP_COL_TO_127;
+    ptr->comScan       = SSD1306_SET_COM_OUTPUT_SCAN__NORMAL;
+    ptr->rotation      = SSD1306_ROTATE_0;
+    ptr->ramp.timer    = NULL;
+    ptr->ramp.active   = false;
+    memset(&ptr->windowStats, 0, sizeof(ptr->windowStats));
+    markClean(ptr);
+    *context = (void *)ptr;
+
+    RESULT ret = initializeDisplay(ptr, contrast);
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "SSD1306_Initialize(): Failed to initialize display. Error = %d.", ret);
+    }
+
+    return ret; 
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to record a changed region of the framebuffer.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+markDirty(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage)
+{
+    for (uint8_t page=spage; page<=epage; page++) {
+        ptr->dirtyStart[page] = MIN(ptr->dirtyStart[page], scol);
+        ptr->dirtyEnd[page]   = MAX(ptr->dirtyEnd[page], ecol);
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to deactivate scrolling and undo what it did to the panel:
+ * the start line is put back after a vertical scroll, and the rotated 
+ * pages are rewritten from the framebuffer if there is one. Must be called
+ * with the bus locked.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+stopScroll(ssd1306_t *ptr)
+{
+    const uint8_t cmds[] = { SSD1306_DEACTIVATE_SCROLL, SSD1306_SET_DISPLAY_START_LINE | ptr->startLine };
+    const bool    wasActive = ptr->scroll.active;
+
+    RESULT ret = sendCommands(ptr, cmds, (wasActive && ptr->scroll.vertical) ? 2 : 1);
+    if (ret != OK) {
+        return ret;
+    }
+    ptr->scroll.active = false;
+
+    if (wasActive && (ptr->framebuffer != NULL)) {
+        ret = flushWindow(ptr, 0, SSD1306_WIDTH-1, ptr->scroll.spage, ptr->scroll.epage);
+        if (ret == OK) {
+            for (uint8_t page=ptr->scroll.spage; page<=ptr->scroll.epage; page++) {
+                ptr->dirtyStart[page] = 0xFF;
+                ptr->dirtyEnd[page]   = 0x00;
+            }
+        }
+    }
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to choose the GDDRAM row shown at the top of the display.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+setStartLine(ssd1306_t *ptr, uint8_t row)
+{
+    const uint8_t cmd = SSD1306_SET_DISPLAY_START_LINE | row;
+
+    RESULT ret = sendCommands(ptr, &cmd, 1);
+    if (ret == OK) {
+        ptr->startLine = row;
+    }
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to send a contrast level and remember it.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+setContrast(ssd1306_t *ptr, uint8_t contrast)
+{
+    const uint8_t cmds[] = { SSD1306_SET_CONTRAST, contrast };
+
+    RESULT ret = sendCommands(ptr, cmds, sizeof(cmds));
+    if (ret == OK) {
+        ptr->contrast = contrast;
+    }
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method run by the ramp timer, on the timer task: sends the next 
+ * contrast level, and stops the timer after the last one.
+ *
+ *  NOTE
+ *      Timer callbacks must not block, so the step only tries the bus lock.
+ *      One that comes due during a frame transfer, or while a caller holds 
+ *      the lock, is skipped and retried on the next expiry; the ramp then 
+ *      ends a period later.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+contrastRampStep(TimerHandle_t timer)
+{
+    ssd1306_t *ptr = (ssd1306_t *)pvTimerGetTimerID(timer);
+    contrast_ramp_t *ramp = &ptr->ramp;
+
+    if (xSemaphoreTakeRecursive(ptr->busLock, 0) != pdTRUE) {
+        return;
+    }
+    if (!ramp->active) {
+        xTimerStop(timer, 0);                       // stopped while the timer was being restarted
+        UNLOCK_BUS(ptr);
+        return;
+    }
+
+    ramp->step++;
+    int level  = ramp->from + (((int)ramp->to - ramp->from) * ramp->step) / ramp->steps;
+    RESULT ret = setContrast(ptr, (uint8_t)level);
+
+    SSD1306_ASYNC_CALLBACK callback = NULL;
+    void *arg = NULL;
+    if ((ret != OK) || (ramp->step >= ramp->steps)) {
+        ramp->active = false;
+        xTimerStop(timer, 0);
+        callback = ramp->callback;
+        arg      = ramp->arg;
+    }
+    UNLOCK_BUS(ptr);
+
+    if (ret != OK) {
+        ESP_LOGE(SSD_TAG, "contrastRampStep(): Failed to set contrast %d. Error = %d.", level, ret);
+    }
+    if (callback != NULL) {
+        callback(arg, ret);
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to write the next console line: as much of text as fits
+ * in SSD1306_WIDTH columns, up to the first '\n'. 
+ *
+ *  OUTPUT
+ *      text - advanced past the characters written and the '\n', if any.
+ *
+ *  NOTE
+ *      Once every page holds a line, the start line moves first so the page
+ *      about to be overwritten, the oldest line, is already at the bottom.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+consoleLine(ssd1306_t *ptr, const char **text)
+{
+    const SSD1306_FONT *font = ptr->console.font;
+    uint8_t line[SSD1306_SEGMENTS];
+    memset(line, 0, sizeof(line));
+
+    const char *c   = *text;
+    uint16_t    col = 0;
+    for (; (*c != '\0') && (*c != '\n'); c++) {
+        const glyph_entry_t *glyph = cachedGlyph(ptr, font, *c, 0);
+        if (glyph == NULL) {
+            return FAILED_TO_ALLOCATE_MEMORY;
+        }
+        if (glyph->width == 0) {
+            continue;
+        }
+        if ((col > 0) && (col + glyph->width > SSD1306_WIDTH)) {
+            break;                                          // wrap, c starts the next line
+        }
+        memcpy(&line[col], glyph->columns, glyph->width);
+        col += glyph->width + font->spacing;
+    }
+    *text = (*c == '\n') ? c + 1 : c;
+
+    const uint8_t page = ptr->console.nextPage;
+    RESULT ret = OK;
+    if (ptr->console.wrapped) {
+        ret = setStartLine(ptr, ((page + 1) % SSD1306_PAGES) * 8);
+    }
+    if (ret == OK) {
+        ret = sendWindow(ptr, 0, SSD1306_WIDTH-1, page, page, line, sizeof(line));
+    }
+    if (ret != OK) {
+        return ret;
+    }
+
+    if (ptr->framebuffer != NULL) {
+        memcpy(ptr->framebuffer + (page * SSD1306_SEGMENTS), line, sizeof(line));
+        ptr->dirtyStart[page] = 0xFF;
+        ptr->dirtyEnd[page]   = 0x00;
+    }
+
+    ptr->console.nextPage = (page + 1) % SSD1306_PAGES;
+    ptr->console.wrapped |= (ptr->console.nextPage == 0);
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to mark every page of the framebuffer as flushed.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+markClean(ssd1306_t *ptr)
+{
+    memset(ptr->dirtyStart, 0xFF, sizeof(ptr->dirtyStart));
+    memset(ptr->dirtyEnd, 0x00, sizeof(ptr->dirtyEnd));
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to find the next window to flush, starting at page.
+ *
+ *  OUTPUT
+ *      false if no page at or after page is dirty.
+ *
+ *  NOTE
+ *      A run of consecutive dirty pages becomes one window covering the 
+ *      union of their dirty columns, as long as the clean bytes this resends
+ *      cost less than opening a separate window (SSD1306_WINDOW_OVERHEAD).
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+nextDirtyWindow(ssd1306_t *ptr, uint8_t page, uint8_t *scol, uint8_t *ecol, uint8_t *spage, uint8_t *epage)
+{
+    while ((page < SSD1306_PAGES) && (ptr->dirtyStart[page] > ptr->dirtyEnd[page])) {
+        page++;
+    }
+
+    if (page >= SSD1306_PAGES) {
+        return false;
+    }
+
+    *spage = *epage = page;
+    *scol  = ptr->dirtyStart[page];
+    *ecol  = ptr->dirtyEnd[page];
+    uint16_t dirtyBytes = *ecol - *scol + 1;
+    while ((*epage+1 < SSD1306_PAGES) && (ptr->dirtyStart[*epage+1] <= ptr->dirtyEnd[*epage+1])) {
+        uint8_t  nscol  = MIN(*scol, ptr->dirtyStart[*epage+1]);
+        uint8_t  necol  = MAX(*ecol, ptr->dirtyEnd[*epage+1]);
+        uint16_t ndirty = dirtyBytes + (ptr->dirtyEnd[*epage+1] - ptr->dirtyStart[*epage+1] + 1);
+        if (((necol - nscol + 1) * (*epage - *spage + 2)) - ndirty > SSD1306_WINDOW_OVERHEAD) {
+            break;
+        }
+        *scol = nscol;
+        *ecol = necol;
+        dirtyBytes = ndirty;
+        (*epage)++;
+    }
+
+    return true;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to send a window of the framebuffer to the display.
+ * Horizontal addressing walks the window page by page, so the page slices 
+ * are streamed straight out of the framebuffer without copying.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+flushWindow(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage)
+{
+    I2C_BUFFER buffers[SSD1306_PAGES];
+    for (uint8_t x=spage; x<=epage; x++) {
+        buffers[x-spage].data   = ptr->framebuffer + (x * SSD1306_SEGMENTS) + scol;
+        buffers[x-spage].length = ecol - scol + 1;
+    }
+
+    return sendWindowBuffers(ptr, scol, ecol, spage, epage, buffers, epage-spage+1);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private methods to set the address window and stream data into it. Both go
+ * in one transaction when the transport supports it; otherwise the bus lock 
+ * is held across the two so that no other task can move the window in 
+ * between.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+sendWindow(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage, 
+           const uint8_t *data, size_t length)
+{
+    const I2C_BUFFER buffer = { data, length };
+    return sendWindowBuffers(ptr, scol, ecol, spage, epage, &buffer, 1);
+}
+
+static RESULT
+sendWindowBuffers(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage, 
+                  const I2C_BUFFER *buffers, size_t count)
+{
+    return sendModeWindowBuffers(ptr, SSD1306_CHEAPEST_ADDRESSING_MODE, scol, ecol, spage, epage, buffers, count);
+}
+
+static RESULT
+sendModeWindowBuffers(ssd1306_t *ptr, uint8_t mode, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage, 
+                      const I2C_BUFFER *buffers, size_t count)
+{
+    size_t length = 0;
+    for (size_t x=0; x<count; x++) {
+        length += buffers[x].length;
+    }
+
+    uint8_t cmds[SSD1306_WINDOW_COMMANDS];
+    LOCK_BUS(ptr);
+    if (mode == SSD1306_CHEAPEST_ADDRESSING_MODE) {
+        mode = chooseAddressingMode(ptr, scol, ecol, spage, epage, length);
+    }
+    RESULT ret = setAddressingMode(ptr, mode);
+    if (ret != OK) {
+        UNLOCK_BUS(ptr);
+        return ret;
+    }
+
+    size_t cmdCount = windowCommands(ptr, scol, ecol, spage, epage, length, cmds);
+    if ((cmdCount > 0) && (cmdCount <= SSD1306_MIXED_MAX_COMMANDS) && (ptr->transport->sendCommandsAndData != NULL)) {
+        ptr->windowStats.mixed++;
+        ret = sendCommandsAndData(ptr, cmds, cmdCount, buffers, count);
+    } else {
+        if (cmdCount > 0) {
+            ret = setWriteLocation(ptr, cmds, cmdCount);
+        }
+        if (ret == OK) {
+            ret = sendDataBuffers(ptr, buffers, count);
+        }
+    }
+    UNLOCK_BUS(ptr);
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to switch the memory addressing mode, if it is not already
+ * mode. The pointer is forgotten, as the datasheet does not say where a 
+ * switch leaves it. Must be called with the bus locked.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+setAddressingMode(ssd1306_t *ptr, uint8_t mode)
+{
+    if (ptr->addressingMode == mode) {
+        return OK;
+    }
+
+    const uint8_t cmds[] = { SSD1306_SET_MEMORY_ADDRESSING_MODE, mode };
+    RESULT ret = sendCommands(ptr, cmds, sizeof(cmds));
+    if (ret == OK) {
+        ptr->addressingMode = mode;
+        ptr->windowStats.modeSwitches++;
+    }
+    ptr->cursor.valid = false;
+    ptr->modeCredit   = 0;
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to pick the addressing mode for a window write. Must be 
+ * called with the bus locked.
+ *
+ *  NOTE
+ *      Only writes inside one page can use page mode; anything else goes 
+ *      horizontal. Otherwise the write is priced in the current mode, with
+ *      the tracked pointer, and in the other mode from scratch, as a switch
+ *      forgets the pointer. What the other mode would have saved builds up
+ *      in modeCredit and the driver switches once it covers the switch's
+ *      own transaction; a write that is cheaper where it is 
+ *      starts over. So a burst of pixels or text runs moves to page mode,
+ *      a single one does not, and a mode is never switched for one write.
+ *      Vertical mode is not a candidate: data is page-major, so its windows
+ *      cost the same as horizontal ones.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static uint8_t
+chooseAddressingMode(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage, size_t length)
+{
+    #if SSD1306_ADAPTIVE_ADDRESSING
+    const bool inPage = (spage == epage) && (length <= (size_t)(ecol - scol + 1));
+    if (!inPage) {
+        return SSD1306_HORIZONTAL_ADDRESSING_MODE;
+    }
+
+    const uint8_t current = ptr->addressingMode;
+    if ((current != SSD1306_HORIZONTAL_ADDRESSING_MODE) && (current != SSD1306_PAGE_ADDRESSING_MODE)) {
+        return SSD1306_PAGE_ADDRESSING_MODE;            // switching either way, page mode's setup is shorter
+    }
+
+    const uint8_t other = (current == SSD1306_PAGE_ADDRESSING_MODE) ? SSD1306_HORIZONTAL_ADDRESSING_MODE
+                                                                    : SSD1306_PAGE_ADDRESSING_MODE;
+    uint8_t cmds[SSD1306_WINDOW_COMMANDS];
+    const size_t here  = commandCost(ptr, buildWindow(ptr, current, scol, ecol, spage, epage, length, cmds));
+    const size_t there = commandCost(ptr, buildWindow(ptr, other, scol, ecol, spage, epage, length, cmds));
+    if (there >= here) {
+        ptr->modeCredit = 0;
+        return current;
+    }
+
+    ptr->modeCredit += here - there;
+    return (ptr->modeCredit >= (SSD1306_MODE_SWITCH_COMMANDS + ptr->transport->commandOverhead)) ? other : current;
+    #else
+    return SSD1306_HORIZONTAL_ADDRESSING_MODE;
+    #endif
+}
+
+#if SSD1306_ADAPTIVE_ADDRESSING
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to estimate the bytes on the wire count window commands 
+ * add to a write: a Co=1 control byte each when they share the data's 
+ * transaction, otherwise the transport's commandOverhead on top of the 
+ * commands, e.g. 2 on I2C and none on SPI.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static size_t
+commandCost(const ssd1306_t *ptr, size_t count)
+{
+    if (count == 0) {
+        return 0;
+    }
+    if ((count <= SSD1306_MIXED_MAX_COMMANDS) && (ptr->transport->sendCommandsAndData != NULL)) {
+        return 2 * count;
+    }
+    return count + ptr->transport->commandOverhead;
+}
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to queue a region for the transmit task, or merge it into a
+ * queued request that already covers it.
+ *
+ *  INPUT
+ *      minTicket - callback waits for at least this sequence number.
+ *      callback  - optional, registered under the same lock as the request so
+ *                  it cannot miss the completion.
+ *
+ *  OUTPUT
+ *      ticket    - sequence number after which the region is on the display.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+enqueueRegion(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage,
+              uint32_t minTicket, SSD1306_ASYNC_CALLBACK callback, void *arg, uint32_t *ticket)
+{
+    ssd1306_async_t *async = ptr->async;
+
+    async_waiter_t *waiter = NULL;
+    if (callback != NULL) {
+        waiter = (async_waiter_t *)malloc(sizeof(async_waiter_t));
+        if (waiter == NULL) {
+            ESP_LOGE(SSD_TAG, "enqueueRegion(): Failed to allocate memory for callback!");
+            return FAILED_TO_ALLOCATE_MEMORY;
+        }
+        waiter->callback = callback;
+        waiter->arg      = arg;
+    }
+
+    int8_t merged = -1;
+    xSemaphoreTake(async->lock, portMAX_DELAY);
+    async->stats.requests++;
+    for (uint8_t x=0; x<SSD1306_ASYNC_QUEUE_DEPTH; x++) {
+        async_request_t *req = &async->slots[x];
+        if (req->pending && (req->scol <= scol) && (req->ecol >= ecol) && 
+                            (req->spage <= spage) && (req->epage >= epage)) {
+            merged = x;
+            *ticket = req->sequence;
+            async->stats.merged++;
+            break;
+        }
+    }
+
+    if (merged < 0) {
+        xSemaphoreGive(async->lock);
+        uint8_t index;
+        xQueueReceive(async->freeSlots, &index, portMAX_DELAY);     // waits only if every slot is in use
+        xSemaphoreTake(async->lock, portMAX_DELAY);
+
+        async_request_t *req = &async->slots[index];
+        req->sequence = ++async->nextSequence;
+        req->enqueued = getCCOUNT();
+        req->scol     = scol;
+        req->ecol     = ecol;
+        req->spage    = spage;
+        req->epage    = epage;
+        req->pending  = true;
+        *ticket = req->sequence;
+
+        async->stats.queueDepth++;
+        async->stats.maxQueueDepth = MAX(async->stats.maxQueueDepth, async->stats.queueDepth);
+        xQueueSend(async->queue, &index, 0);                        // sent under lock, so queue order == sequence order
+    }
+
+    if ((int32_t)(*ticket - minTicket) < 0) {
+        *ticket = minTicket;
+    }
+
+    if (waiter != NULL) {
+        waiter->ticket = *ticket;
+        waiter->next   = async->waiters;
+        async->waiters = waiter;
+    }
+    xSemaphoreGive(async->lock);
     return OK;
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- * Private method to send a command to the ssd1306 display. 
- *
- * Commands require Continuation bit to be set to 1.
+ * Private transmit task body. Owns the bus while sending a request and runs 
+ * the callbacks whose ticket has completed.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
-static inline 
-RESULT sendCommand(ssd1306_t *ptr, uint8_t cmd) 
+static void
+asyncTransmitTask(void *arg)
 {
-    RESULT ret = I2C_Write(ptr->i2c, cmd);
-    if (ret != OK) {
-        ESP_LOGE(SSD_TAG, "sendCommand(): Failed to send command: 0x%x! Error = %d", cmd, ret);
+    ssd1306_t *ptr = (ssd1306_t *)arg;
+    ssd1306_async_t *async = ptr->async;
+    uint8_t index;
+
+    while (xQueueReceive(async->queue, &index, portMAX_DELAY) == pdTRUE) {
+        if (index == SSD1306_ASYNC_STOP) {
+            break;
+        }
+
+        xSemaphoreTake(async->lock, portMAX_DELAY);
+        async_request_t req = async->slots[index];
+        async->slots[index].pending = false;                // framebuffer is read from here on, no more merging
+        async->stats.queueDepth--;
+        xSemaphoreGive(async->lock);
+
+        RESULT ret = flushWindow(ptr, req.scol, req.ecol, req.spage, req.epage);
+        uint32_t latency = (getCCOUNT() - req.enqueued) / CPU_FREQ_MHZ;
+
+        xSemaphoreTake(async->lock, portMAX_DELAY);
+        async->completedSequence = req.sequence;
+        async->stats.completed++;
+        if (ret != OK) {
+            async->stats.failed++;
+        }
+        async->stats.lastLatencyUs = latency;
+        async->stats.maxLatencyUs  = MAX(async->stats.maxLatencyUs, latency);
+
+        async_waiter_t *done = NULL, **link = &async->waiters;
+        while (*link != NULL) {
+            async_waiter_t *waiter = *link;
+            if ((int32_t)(waiter->ticket - req.sequence) <= 0) {
+                *link = waiter->next;
+                waiter->next = done;
+                done = waiter;
+            } else {
+                link = &waiter->next;
+            }
+        }
+        xSemaphoreGive(async->lock);
+        xQueueSend(async->freeSlots, &index, 0);
+
+        while (done != NULL) {
+            async_waiter_t *next = done->next;
+            done->callback(done->arg, ret);
+            free(done);
+            done = next;
+        }
     }
 
-    return ret;
+    xSemaphoreGive(async->stopped);
+    vTaskDelete(NULL);
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- * Private method to set cursor position prior to write. 
+ * Private method to set cursor position prior to write, in a transaction of
+ * its own. cmds come from windowCommands(). Must be called with the bus 
+ * locked.
  *
  *  NOTE
  *      This method assums Column Addressing scheme.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 static RESULT 
-setWriteLocation(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage)
-{
-    RESULT ret;
-    I2C_StartXmit(ptr->i2c);
-    SSD1306_SEND_CMD(ptr, SSD1306_COMMAND_MULTI_BYTE, ret);      
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_COLUMN_ADDRESS, ret);
-    SSD1306_SEND_CMD(ptr, scol, ret); 
-    SSD1306_SEND_CMD(ptr, ecol, ret); 
-    SSD1306_SEND_CMD(ptr, SSD1306_SET_PAGE_ADDRESS, ret);
-    SSD1306_SEND_CMD(ptr, spage, ret); 
-    SSD1306_SEND_CMD(ptr, epage, ret); 
-    I2C_StopXmit(ptr->i2c);
-    return OK;
+setWriteLocation(ssd1306_t *ptr, const uint8_t *cmds, size_t count)
+{
+    RESULT ret = sendCommands(ptr, cmds, count);
+    if (ret == OK) {
+        commitWindow(ptr, cmds, count);
+    }
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to build the commands that set the window for a write of
+ * length bytes in the current addressing mode, SSD1306_WINDOW_COMMANDS at 
+ * most. Returns how many there are, 0 when the pointer is already in place.
+ * Must be called with the bus locked.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static size_t
+windowCommands(ssd1306_t *ptr, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage, size_t length, 
+               uint8_t *cmds)
+{
+    size_t count = buildWindow(ptr, ptr->addressingMode, scol, ecol, spage, epage, length, cmds);
+
+    ptr->windowStats.windows++;
+    ptr->windowStats.bytesSaved += SSD1306_WINDOW_COMMANDS - count;
+    if (ptr->addressingMode == SSD1306_PAGE_ADDRESSING_MODE) {
+        ptr->windowStats.pageMode++;
+    }
+    if (count == 0) {
+        ptr->windowStats.skipped++;
+    } else if (count < SSD1306_WINDOW_COMMANDS) {
+        ptr->windowStats.shrunk++;
+    }
+    return count;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to build window commands for mode. The tracked pointer is 
+ * only used when the panel is already in mode.
+ *
+ *  NOTE
+ *      With SSD1306_TRACK_CURSOR the commands that would not change where 
+ *      the bytes land are dropped: 
+ *        - the column range when the pointer is on scol and the columns 
+ *          match, or, for a write inside one page, leave room for it,
+ *        - the page range when the pointer is on spage and the pages 
+ *          reach epage, or the write stays inside one page,
+ *        - in page mode, the page and either column nibble that already 
+ *          match.
+ *      Horizontal windows for writes inside one page are opened to the 
+ *      right and bottom edges, so the next write further along the page 
+ *      finds the pointer already in place.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static size_t
+buildWindow(const ssd1306_t *ptr, uint8_t mode, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage, 
+            size_t length, uint8_t *cmds)
+{
+    const cursor_t *cur = &ptr->cursor;
+    const bool tracked  = SSD1306_TRACK_CURSOR && cur->valid && (mode == ptr->addressingMode);
+    size_t count = 0;
+
+    if (mode == SSD1306_PAGE_ADDRESSING_MODE) {
+        if (!tracked || (cur->page != spage)) {
+            cmds[count++] = SSD1306_SET_PAGE_START_ADDRESS | spage;
+        }
+        if (!tracked || ((cur->col & 0x0F) != (scol & 0x0F))) {
+            cmds[count++] = SSD1306_SET_LOWER_COLUMN_START | (scol & 0x0F);
+        }
+        if (!tracked || ((cur->col >> 4) != (scol >> 4))) {
+            cmds[count++] = SSD1306_SET_HIGHER_COLUMN_START | (scol >> 4);
+        }
+        return count;
+    }
+
+    bool colsSet  = false;
+    bool pagesSet = false;
+    const bool inPage = (mode == SSD1306_HORIZONTAL_ADDRESSING_MODE) && 
+                        (spage == epage) && (length <= (size_t)(ecol - scol + 1));
+    if (tracked && (cur->col == scol)) {
+        colsSet = inPage ? ((size_t)(cur->ecol - scol + 1) >= length) 
+                         : ((cur->scol == scol) && (cur->ecol == ecol));
+    }
+    if (tracked && (cur->page == spage)) {
+        pagesSet = inPage || (cur->epage >= epage);
+    }
+    if (SSD1306_TRACK_CURSOR && inPage) {
+        ecol  = SSD1306_WIDTH-1;
+        epage = SSD1306_PAGES-1;
+    }
+
+    if (!colsSet) {
+        cmds[count++] = SSD1306_SET_COLUMN_ADDRESS;
+        cmds[count++] = scol;
+        cmds[count++] = ecol;
+    }
+    if (!pagesSet) {
+        cmds[count++] = SSD1306_SET_PAGE_ADDRESS;
+        cmds[count++] = spage;
+        cmds[count++] = epage;
+    }
+    return count;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to update the tracked pointer once commands from 
+ * windowCommands() have been sent.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+commitWindow(ssd1306_t *ptr, const uint8_t *cmds, size_t length)
+{
+    cursor_t *cur = &ptr->cursor;
+    for (size_t x=0; x<length; x++) {
+        if (cmds[x] == SSD1306_SET_COLUMN_ADDRESS) {
+            cur->scol = cur->col = cmds[x+1];
+            cur->ecol = cmds[x+2];
+            x += 2;
+        } else if (cmds[x] == SSD1306_SET_PAGE_ADDRESS) {
+            cur->spage = cur->page = cmds[x+1];
+            cur->epage = cmds[x+2];
+            x += 2;
+        } else if ((cmds[x] & 0xF8) == SSD1306_SET_PAGE_START_ADDRESS) {
+            cur->page = cmds[x] & 0x07;
+        } else if (cmds[x] < SSD1306_SET_HIGHER_COLUMN_START) {
+            cur->col = (cur->col & 0xF0) | (cmds[x] & 0x0F);
+        } else {
+            cur->col = (cur->col & 0x0F) | ((cmds[x] & 0x07) << 4);
+        }
+    }
+    cur->valid = true;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to move the tracked pointer past length data bytes, the
+ * way the current addressing mode does: along the page in horizontal mode,
+ * down the column in vertical mode. Page mode writes never leave their 
+ * page; one that reaches the last column is forgotten, as the datasheet 
+ * does not make clear where the column wraps to.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+advanceCursor(ssd1306_t *ptr, size_t length)
+{
+    cursor_t *cur = &ptr->cursor;
+    if (!cur->valid) {
+        return;
+    }
+
+    if (ptr->addressingMode == SSD1306_PAGE_ADDRESSING_MODE) {
+        if (cur->col + length >= SSD1306_WIDTH) {
+            cur->valid = false;
+        } else {
+            cur->col += length;
+        }
+        return;
+    }
+
+    const uint32_t width  = cur->ecol - cur->scol + 1;
+    const uint32_t height = cur->epage - cur->spage + 1;
+    if (ptr->addressingMode == SSD1306_VERTICAL_ADDRESSING_MODE) {
+        const uint32_t offset = (((cur->col - cur->scol) * height) + (cur->page - cur->spage) + length) % (width * height);
+        cur->col  = cur->scol + (offset / height);
+        cur->page = cur->spage + (offset % height);
+        return;
+    }
+
+    const uint32_t offset = (((cur->page - cur->spage) * width) + (cur->col - cur->scol) + length) % (width * height);
+    cur->page = cur->spage + (offset / width);
+    cur->col  = cur->scol + (offset % width);
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
@@ -605,9 +3077,10 @@ drawPixel(ssd1306_t *ptr, uint8_t row, uint8_t col)
 {
     uint8_t pageId = row/SSD1306_PAGES;
 
-    RESULT ret = setWriteLocation(ptr, col, col, pageId, pageId);
-    if (ret != OK) {
-        return ret;
+    if (ptr->framebuffer != NULL) {
+        ptr->framebuffer[(pageId * SSD1306_SEGMENTS) + col] |= 1<<(row-(8*pageId));
+        markDirty(ptr, col, col, pageId, pageId);
+        return OK;
     }
 
     // NOTE: Need to light up the appropriate column-bit. 
@@ -615,9 +3088,442 @@ drawPixel(ssd1306_t *ptr, uint8_t row, uint8_t col)
     //       e.g. row = 30 (pageId=30/8=3)
     //       light up column 7th bit from bottom. 
     //       1 << (30 - 24) => 1 << 6 = 0b01000000
-    I2C_StartXmit(ptr->i2c);
-    SSD1306_SEND_CMD(ptr, SSD1306_DATA_STREAM, ret);            
-    I2C_Write(ptr->i2c, 1<<(row-(8*pageId)));
-    I2C_StopXmit(ptr->i2c);
+    const uint8_t data = 1<<(row-(8*pageId));
+    return sendWindow(ptr, col, col, pageId, pageId, &data, 1);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method to draw a line with integer Bresenham, endpoints included.
+ *
+ * The line is walked along its major axis one run at a time: a shallow line
+ * is a series of row runs, each ORed into a span of bytes; a steep line is a
+ * series of column runs, each ORed as whole-byte masks per page. Bits are
+ * gathered per page and written once per page: into the framebuffer, or as
+ * one window per page, which, like drawPixel(), overwrites the unlit bits of
+ * the bytes the line passes through.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT 
+drawLine(ssd1306_t *ptr, uint8_t r1, uint8_t c1, uint8_t r2, uint8_t c2)
+{
+    if (r1 > r2) {                              // walk top to bottom
+        uint8_t t;
+        t = r1; r1 = r2; r2 = t;
+        t = c1; c1 = c2; c2 = t;
+    }
+
+    line_strip_t strip;
+    stripInit(&strip, ptr, SSD1306_DRAW_SET);
+
+    int dx = (c2 >= c1) ? c2 - c1 : c1 - c2;
+    int dy = r2 - r1;
+    int sx = (c2 >= c1) ? 1 : -1;
+    int row = r1;
+    int col = c1;
+
+    if (dx >= dy) {
+        // shallow: one row run per step in row
+        int err = 2*dy - dx;
+        int runStart = col;
+        for (int i = 0; i <= dx; i++, col += sx) {
+            if ((err > 0) || (i == dx)) {
+                stripRowRun(&strip, row, runStart, col);
+                runStart = col + sx;
+            }
+            if (err > 0) {
+                row++;
+                err -= 2*dx;
+            }
+            err += 2*dy;
+        }
+    } else {
+        // steep: one column run per step in column
+        int err = 2*dx - dy;
+        int runStart = row;
+        for (int i = 0; i <= dy; i++, row++) {
+            if ((err > 0) || (i == dy)) {
+                stripColumnRun(&strip, col, runStart, row);
+                runStart = row + 1;
+            }
+            if (err > 0) {
+                col += sx;
+                err -= 2*dy;
+            }
+            err += 2*dx;
+        }
+    }
+
+    stripFlush(&strip);
+    return strip.result;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private methods to OR a run of pixels into the line strip. Runs arrive in
+ * increasing row order, so moving to a new page flushes the current one.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+stripInit(line_strip_t *strip, ssd1306_t *ptr, SSD1306_DRAW_MODE mode)
+{
+    strip->ptr    = ptr;
+    strip->page   = 0;
+    strip->minCol = SSD1306_SEGMENTS-1;
+    strip->maxCol = 0;
+    strip->mode   = mode;
+    strip->result = OK;
+    memset(strip->bits, 0, sizeof(strip->bits));
+}
+
+static void
+stripClippedRowRun(line_strip_t *strip, int row, int c1, int c2)
+{
+    if ((row < 0) || (row >= SSD1306_HEIGHT) || (c2 < 0) || (c1 >= SSD1306_WIDTH)) {
+        return;
+    }
+
+    stripRowRun(strip, row, MAX(c1, 0), MIN(c2, SSD1306_WIDTH-1));
+}
+
+static void
+stripRowRun(line_strip_t *strip, uint8_t row, uint8_t c1, uint8_t c2)
+{
+    uint8_t first = MIN(c1, c2);
+    uint8_t last  = MAX(c1, c2);
+    uint8_t bit   = 1 << (row & 7);
+
+    stripSetPage(strip, row/8);
+    for (uint8_t x = first; x <= last; x++) {
+        strip->bits[x] |= bit;
+    }
+    strip->minCol = MIN(strip->minCol, first);
+    strip->maxCol = MAX(strip->maxCol, last);
+}
+
+static void
+stripColumnRun(line_strip_t *strip, uint8_t col, uint8_t r1, uint8_t r2)
+{
+    for (uint8_t page = r1/8; page <= r2/8; page++) {
+        // bits of rows [r1, r2] that fall inside page
+        uint8_t first = (page == r1/8) ? r1 & 7 : 0;
+        uint8_t last  = (page == r2/8) ? r2 & 7 : 7;
+
+        stripSetPage(strip, page);
+        strip->bits[col] |= (uint8_t)((0xFF << first) & (0xFF >> (7-last)));
+        strip->minCol = MIN(strip->minCol, col);
+        strip->maxCol = MAX(strip->maxCol, col);
+    }
+}
+
+static void
+stripSetPage(line_strip_t *strip, uint8_t page)
+{
+    if (page != strip->page) {
+        stripFlush(strip);
+        strip->page = page;
+    }
+}
+
+static void
+stripFlush(line_strip_t *strip)
+{
+    if (strip->minCol > strip->maxCol) {
+        return;
+    }
+
+    ssd1306_t *ptr = strip->ptr;
+    uint8_t width = strip->maxCol - strip->minCol + 1;
+    if (ptr->framebuffer != NULL) {
+        uint8_t *dst = ptr->framebuffer + (strip->page * SSD1306_SEGMENTS);
+        for (uint8_t x = strip->minCol; x <= strip->maxCol; x++) {
+            APPLY_MASK(dst[x], strip->bits[x], strip->mode);
+        }
+        markDirty(ptr, strip->minCol, strip->maxCol, strip->page, strip->page);
+    } else {
+        if (strip->mode == SSD1306_DRAW_CLEAR) {
+            memset(strip->bits + strip->minCol, 0, width);
+        }
+        RESULT ret = sendWindow(ptr, strip->minCol, strip->maxCol, strip->page, strip->page, 
+                                strip->bits + strip->minCol, width);
+        if (strip->result == OK) {
+            strip->result = ret;
+        }
+    }
+
+    memset(strip->bits + strip->minCol, 0, width);
+    strip->minCol = SSD1306_SEGMENTS-1;
+    strip->maxCol = 0;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method to validate a draw mode. Invert has to read the pixels it
+ * flips, which only the framebuffer can do.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+checkDrawMode(ssd1306_t *ptr, SSD1306_DRAW_MODE mode, const char *fn)
+{
+    if ((mode != SSD1306_DRAW_SET) && (mode != SSD1306_DRAW_CLEAR) && (mode != SSD1306_DRAW_INVERT)) {
+        ESP_LOGE(SSD_TAG, "%s(): Invalid draw mode %d.", fn, mode);
+        return INVALID_ARGUMENT;
+    }
+
+    if ((mode == SSD1306_DRAW_INVERT) && (ptr->framebuffer == NULL)) {
+        ESP_LOGE(SSD_TAG, "%s(): Invert mode needs the framebuffer enabled.", fn);
+        return NOT_IMPLEMENTED;
+    }
+
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method to tell whether the display is turned to portrait, where 
+ * drawing coordinates are transposed, see SSD1306_SetRotation().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static inline bool
+isPortrait(const ssd1306_t *ptr)
+{
+    return (ptr->rotation == SSD1306_ROTATE_90) || (ptr->rotation == SSD1306_ROTATE_270);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method to reject calls laid out in pages while in portrait.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+checkLandscape(const ssd1306_t *ptr, const char *fn)
+{
+    if (isPortrait(ptr)) {
+        ESP_LOGE(SSD_TAG, "%s(): Needs a 0 or 180 degree rotation.", fn);
+        return INVALID_STATE_CHANGE_REQUEST;
+    }
+
     return OK;
 }
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method to fetch a glyph shifted down by shift rows, filling its 
+ * cache entry from the font on a miss. Called with the bus lock held, which
+ * also guards the cache. Returns NULL if the cache cannot be allocated.
+ * Glyphs wider than SSD1306_FONT_MAX_WIDTH are clipped on the right.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static const glyph_entry_t *
+cachedGlyph(ssd1306_t *ptr, const SSD1306_FONT *font, char c, uint8_t shift)
+{
+    if (ptr->glyphs == NULL) {
+        ptr->glyphs = (glyph_entry_t *)calloc(SSD1306_GLYPH_CACHE_ENTRIES, sizeof(glyph_entry_t));
+        if (ptr->glyphs == NULL) {
+            ESP_LOGE(SSD_TAG, "cachedGlyph(): Failed to allocate glyph cache!");
+            return NULL;
+        }
+    }
+
+    uint8_t code = (uint8_t)c;
+    uint32_t slot = (code ^ (shift << 5) ^ ((uint32_t)font >> 2)) & (SSD1306_GLYPH_CACHE_ENTRIES - 1);
+    glyph_entry_t *entry = &ptr->glyphs[slot];
+    if ((entry->font == font) && (entry->code == code) && (entry->shift == shift)) {
+        return entry;
+    }
+
+    const uint8_t *src;
+    uint8_t stride = SSD1306_FontGlyph(font, c, &src);     // the glyph's pages are stride bytes apart
+    uint8_t width  = MIN(stride, SSD1306_FONT_MAX_WIDTH);
+    uint8_t pages  = (font->height + 7) / 8;
+
+    entry->font  = font;
+    entry->code  = code;
+    entry->shift = shift;
+    entry->width = width;
+    memset(entry->columns, 0, (pages + 1) * width);
+    for (uint8_t p = 0; p < pages; p++) {
+        for (uint8_t x = 0; x < width; x++) {
+            uint8_t bits = SSD1306_FontReadByte(&src[(p * stride) + x]);
+            entry->columns[(p * width) + x] |= bits << shift;
+            if (shift != 0) {
+                entry->columns[((p + 1) * width) + x] |= bits >> (8 - shift);
+            }
+        }
+    }
+
+    return entry;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method to build one destination page of a blit, columns [scol, 
+ * ecol]: out = (lo << shift) | (hi >> (8 - shift)), each source byte first 
+ * limited to its valid rows. out is indexed by destination column, lo and
+ * hi by source column, starting at scol; either may be NULL. lo and hi are
+ * only read with aligned 32-bit loads, so they may be in flash.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+blitGather(uint8_t *out, const uint8_t *lo, const uint8_t *hi, uint8_t loValid, uint8_t hiValid, 
+           uint8_t shift, uint8_t scol, uint8_t ecol)
+{
+    // shifting a whole word moves bits across bytes; the lane masks drop them
+    uint32_t loLanes = 0x01010101U * (uint8_t)(loValid << shift);
+    uint32_t loKeep  = 0x01010101U * loValid;
+    uint32_t hiLanes = (shift != 0) ? 0x01010101U * (uint8_t)(hiValid >> (8 - shift)) : 0;
+    uint32_t hiKeep  = 0x01010101U * hiValid;
+
+    uint8_t x = scol;
+    for (; x <= ecol; ) {
+        if (((x & 3) == 0) && (x + 3 <= ecol)) {
+            uint32_t word = 0;
+            if (lo != NULL) {
+                word |= ((loadWord(lo + x - scol) & loKeep) << shift) & loLanes;
+            }
+            if (hi != NULL) {
+                word |= ((loadWord(hi + x - scol) & hiKeep) >> (8 - shift)) & hiLanes;
+            }
+            *(uint32_t *)(out + x) = word;
+            x += 4;
+        } else {
+            uint8_t byte = 0;
+            if (lo != NULL) {
+                byte |= (uint8_t)((SSD1306_FontReadByte(lo + x - scol) & loValid) << shift);
+            }
+            if (hi != NULL) {
+                byte |= (uint8_t)((SSD1306_FontReadByte(hi + x - scol) & hiValid) >> (8 - shift));
+            }
+            out[x] = byte;
+            x++;
+        }
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method to combine a gathered page into a framebuffer page row 
+ * where mask is set, four columns per word where aligned.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#define BLIT_OP(d, s, m, op) \
+    switch (op) { \
+        case SSD1306_BLIT_COPY: d = (d & ~(m)) | ((s) & (m)); break; \
+        case SSD1306_BLIT_OR:   d |= (s) & (m); break; \
+        case SSD1306_BLIT_AND:  d &= (s) | ~(m); break; \
+        default:                d ^= (s) & (m); break; \
+    }
+
+static void
+blitApply(uint8_t *dst, const uint8_t *src, const uint8_t *mask, uint8_t scol, uint8_t ecol, SSD1306_BLIT_OP op)
+{
+    uint8_t x = scol;
+    for (; (x <= ecol) && (x & 3); x++) {
+        BLIT_OP(dst[x], src[x], mask[x], op);
+    }
+
+    for (; x + 3 <= ecol; x += 4) {
+        uint32_t *d = (uint32_t *)(dst + x);
+        uint32_t s = *(const uint32_t *)(src + x);
+        uint32_t m = *(const uint32_t *)(mask + x);
+        BLIT_OP(*d, s, m, op);
+    }
+
+    for (; x <= ecol; x++) {
+        BLIT_OP(dst[x], src[x], mask[x], op);
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method to load four bytes from any alignment, little-endian. 
+ * Unaligned bytes come from the two aligned words around them, so like 
+ * SSD1306_FontReadByte() it never makes a byte load and works from flash.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static inline uint32_t
+loadWord(const uint8_t *p)
+{
+    const uint32_t *word  = (const uint32_t *)((uintptr_t)p & ~(uintptr_t)3);
+    const uint32_t offset = 8 * ((uintptr_t)p & 3);
+    if (offset == 0) {
+        return word[0];
+    }
+
+    return (word[0] >> offset) | (word[1] << (32 - offset));
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method returning the bits of rows [first, last] that fall in page.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static uint8_t
+pageMask(uint8_t page, int first, int last)
+{
+    int lo = MAX(first, page*8);
+    int hi = MIN(last, page*8 + 7);
+    if (lo > hi) {
+        return 0;
+    }
+
+    return (uint8_t)((0xFF << (lo & 7)) & (0xFF >> (7 - (hi & 7))));
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method to apply masks to columns [scol, ecol] of a page: leftMask
+ * to scol, rightMask to ecol and innerMask to the columns in between.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+applyPageRow(ssd1306_t *ptr, uint8_t page, uint8_t scol, uint8_t ecol, 
+             uint8_t leftMask, uint8_t innerMask, uint8_t rightMask, SSD1306_DRAW_MODE mode)
+{
+    if (ptr->framebuffer != NULL) {
+        uint8_t *row = ptr->framebuffer + (page * SSD1306_SEGMENTS);
+        applySpan(row, scol, scol, leftMask, mode);
+        if (ecol > scol) {
+            if (ecol > scol+1) {
+                applySpan(row, scol+1, ecol-1, innerMask, mode);
+            }
+            applySpan(row, ecol, ecol, rightMask, mode);
+        }
+        markDirty(ptr, scol, ecol, page, page);
+        return OK;
+    }
+
+    // No framebuffer to merge with: set mode writes the masks, clear writes 0s.
+    // With nothing between the edges, e.g. the sides of an outline, only the
+    // edge columns are written so the columns in between are left alone.
+    if ((innerMask == 0) && (ecol > scol+1)) {
+        uint8_t edge = (mode == SSD1306_DRAW_CLEAR) ? 0 : leftMask;
+        RESULT  ret  = OK;
+        if (leftMask != 0) {
+            ret = sendWindow(ptr, scol, scol, page, page, &edge, 1);
+        }
+        if ((ret == OK) && (rightMask != 0)) {
+            edge = (mode == SSD1306_DRAW_CLEAR) ? 0 : rightMask;
+            ret  = sendWindow(ptr, ecol, ecol, page, page, &edge, 1);
+        }
+        return ret;
+    }
+
+    uint8_t row[SSD1306_SEGMENTS];
+    uint8_t width = ecol - scol + 1;
+    if (mode == SSD1306_DRAW_CLEAR) {
+        memset(row, 0, width);
+    } else {
+        memset(row, innerMask, width);
+        row[0] = leftMask;
+        if (ecol > scol) {
+            row[width-1] = rightMask;
+        }
+    }
+
+    return sendWindow(ptr, scol, ecol, page, page, row, width);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Private method to apply mask to columns [scol, ecol] of a framebuffer page
+ * row, four columns per word. Page rows are word aligned.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+applySpan(uint8_t *row, uint8_t scol, uint8_t ecol, uint8_t mask, SSD1306_DRAW_MODE mode)
+{
+    if (mask == 0) {
+        return;
+    }
+
+    uint8_t x = scol;
+    for (; (x <= ecol) && (x & 3); x++) {
+        APPLY_MASK(row[x], mask, mode);
+    }
+
+    uint32_t mask32 = mask * 0x01010101U;
+    for (; x + 3 <= ecol; x += 4) {
+        APPLY_MASK(*(uint32_t *)(row + x), mask32, mode);
+    }
+
+    for (; x <= ecol; x++) {
+        APPLY_MASK(row[x], mask, mode);
+    }
+}
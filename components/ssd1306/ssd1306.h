@@ -27,16 +27,101 @@
 #define SSD1306_WIDTH   128
 #define SSD1306_HEIGHT   64
 
+// Bytes per row of a row-major 1bpp image, see SSD1306_RowsToPages().
+#define SSD1306_ROW_STRIDE(width)   (((width) + 7) / 8)
+#define SSD1306_PORTRAIT_WIDTH      SSD1306_HEIGHT
+#define SSD1306_PORTRAIT_HEIGHT     SSD1306_WIDTH
+
 typedef struct _PAGE {
-    uint8_t page[16];
+    uint8_t page[SSD1306_WIDTH];    // one byte per segment, LSB is the top row.
 }PAGE;
 
+typedef enum _SSD1306_DRAW_MODE {
+    SSD1306_DRAW_SET,           // light the shape's pixels.
+    SSD1306_DRAW_CLEAR,         // turn the shape's pixels off.
+    SSD1306_DRAW_INVERT         // flip the shape's pixels, needs the framebuffer.
+}SSD1306_DRAW_MODE;
+
+typedef enum _SSD1306_BLIT_OP {
+    SSD1306_BLIT_COPY,          // destination = source.
+    SSD1306_BLIT_OR,            // destination |= source.
+    SSD1306_BLIT_AND,           // destination &= source, needs the framebuffer.
+    SSD1306_BLIT_XOR            // destination ^= source, needs the framebuffer.
+}SSD1306_BLIT_OP;
+
+typedef enum _SSD1306_SCROLL_DIRECTION {
+    SSD1306_SCROLL_RIGHT,
+    SSD1306_SCROLL_LEFT
+}SSD1306_SCROLL_DIRECTION;
+
+typedef enum _SSD1306_SCROLL_SPEED {    // frames between scroll steps, values are the controller's encoding.
+    SSD1306_SCROLL_5_FRAMES     = 0,
+    SSD1306_SCROLL_64_FRAMES    = 1,
+    SSD1306_SCROLL_128_FRAMES   = 2,
+    SSD1306_SCROLL_256_FRAMES   = 3,
+    SSD1306_SCROLL_3_FRAMES     = 4,
+    SSD1306_SCROLL_4_FRAMES     = 5,
+    SSD1306_SCROLL_25_FRAMES    = 6,
+    SSD1306_SCROLL_2_FRAMES     = 7
+}SSD1306_SCROLL_SPEED;
+
+typedef struct _SSD1306_SCROLL {
+    SSD1306_SCROLL_DIRECTION direction;
+    SSD1306_SCROLL_SPEED     speed;
+    uint8_t     startPage;      // pages that move horizontally, startPage <= endPage.
+    uint8_t     endPage;
+    uint8_t     verticalOffset; // rows moved up per step, 0 scrolls horizontally only.
+    uint8_t     fixedRows;      // vertical scroll area: rows at the top that stay put,
+    uint8_t     scrollRows;     // and rows below them that move, 0 for the rest of the display.
+}SSD1306_SCROLL;
+
+typedef enum _SSD1306_FADE {     // values are the controller's A[5:4] encoding.
+    SSD1306_FADE_DISABLED       = 0x00,
+    SSD1306_FADE_OUT            = 0x20,     // contrast steps down to 0 and stays there.
+    SSD1306_FADE_BLINK          = 0x30      // contrast steps down and back up, continuously.
+}SSD1306_FADE;
+
+typedef enum _SSD1306_ROTATION {   // clockwise, relative to the panel's default orientation.
+    SSD1306_ROTATE_0,
+    SSD1306_ROTATE_90,              // portrait, see SSD1306_UpdatePortrait().
+    SSD1306_ROTATE_180,
+    SSD1306_ROTATE_270              // portrait.
+}SSD1306_ROTATION;
+
 typedef struct _POINT {
     uint8_t row;
     uint8_t col;
 }POINT;
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Async mode: completion callback, runs on the transmit task.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef void (*SSD1306_ASYNC_CALLBACK)(void *arg, RESULT result);
+
+typedef struct _SSD1306_ASYNC_STATS {
+    uint32_t    requests;       // regions requested, including merged ones.
+    uint32_t    merged;         // requests absorbed by a region already queued.
+    uint32_t    completed;      // regions sent.
+    uint32_t    failed;         // regions whose transfer returned an error.
+    uint32_t    queueDepth;     // regions currently queued.
+    uint32_t    maxQueueDepth;  // high-water mark of queueDepth.
+    uint32_t    lastLatencyUs;  // queued-to-sent time of the last region.
+    uint32_t    maxLatencyUs;   // worst queued-to-sent time.
+}SSD1306_ASYNC_STATS;
+
+typedef struct _SSD1306_WINDOW_STATS {
+    uint32_t    windows;        // address windows drawing calls asked for.
+    uint32_t    skipped;        // ... that found the pointer already in place, no commands sent.
+    uint32_t    shrunk;         // ... that only needed the column or the page range sent.
+    uint32_t    mixed;          // ... sent in the same transaction as their data.
+    uint32_t    bytesSaved;     // window setup command bytes not sent, against a full 6-byte window.
+    uint32_t    pageMode;       // windows set in page addressing mode.
+    uint32_t    modeSwitches;   // addressing mode changes, 2 command bytes each.
+}SSD1306_WINDOW_STATS;
+
 RESULT SSD1306_Initialize(uint8_t slaveAddress, uint8_t scl, uint8_t sda, uint8_t contrast, void **context);
+RESULT SSD1306_InitializeLanes(uint8_t slaveAddress, uint8_t scl, const uint8_t *sda, uint8_t laneCount, 
+                               uint8_t contrast, void **context);
 RESULT SSD1306_FreeContext(void **ppContext);
 RESULT SSD1306_TurnDisplayOn(const void *context);
 RESULT SSD1306_TurnDisplayOff(const void *context);
@@ -44,9 +129,43 @@ RESULT SSD1306_FillDisplay(const void *context, uint8_t fillChar);
 RESULT SSD1306_ClearDisplay(const void *context);
 RESULT SSD1306_DrawPixel(const void *context, uint8_t row, uint8_t col); 
 RESULT SSD1306_DrawLine(const void *context, const POINT p1, const POINT p2);
-RESULT SSD1306_DrawCircle(const void *context, const POINT center, uint8_t radius);
-RESULT SSD1306_DrawRectangle(const void *context, const POINT p1, const POINT p2, const POINT p3, const POINT p4);
+RESULT SSD1306_DrawCircle(const void *context, const POINT center, uint8_t radius, bool filled, 
+                          SSD1306_DRAW_MODE mode);
+RESULT SSD1306_DrawRectangle(const void *context, const POINT p1, const POINT p2, bool filled, 
+                             SSD1306_DRAW_MODE mode);
 RESULT SSD1306_SetContrast(const void *context, uint8_t contrast); 
+RESULT SSD1306_StartContrastRamp(const void *context, uint8_t contrast, uint32_t durationMs, 
+                                 SSD1306_ASYNC_CALLBACK callback, void *arg);
+RESULT SSD1306_StopContrastRamp(const void *context);
+RESULT SSD1306_SetFade(const void *context, SSD1306_FADE fade, uint8_t frames);
+RESULT SSD1306_SetInverted(const void *context, bool inverted);
+RESULT SSD1306_SetEntireDisplayOn(const void *context, bool on);
+RESULT SSD1306_SetZoom(const void *context, bool zoom);
+RESULT SSD1306_SetRotation(const void *context, SSD1306_ROTATION rotation, bool mirrorX, bool mirrorY);
+RESULT SSD1306_UpdatePortrait(const void *context, const uint8_t *rows);
+RESULT SSD1306_StartScroll(const void *context, const SSD1306_SCROLL *scroll);
+RESULT SSD1306_StopScroll(const void *context);
+RESULT SSD1306_SetBusSpeed(const void *context, I2C_BUS_SPEED speed);
 RESULT SSD1306_UpdatePage(const void *context, uint8_t pageId, const PAGE *page);
+RESULT SSD1306_Blit(const void *context, const POINT origin, uint8_t width, uint8_t height, 
+                    const uint8_t *bits, const uint8_t *mask, SSD1306_BLIT_OP op);
+RESULT SSD1306_UpdatePages(const void *context, uint8_t firstPage, uint8_t count, const PAGE *pages);
+RESULT SSD1306_EnableFramebuffer(const void *context, bool enable);
+RESULT SSD1306_Flush(const void *context);
+RESULT SSD1306_StartAsync(const void *context, UBaseType_t priority);
+RESULT SSD1306_StopAsync(const void *context);
+RESULT SSD1306_UpdateRegionAsync(const void *context, uint8_t scol, uint8_t ecol, uint8_t spage, uint8_t epage,
+                                 SSD1306_ASYNC_CALLBACK callback, void *arg);
+RESULT SSD1306_FlushAsync(const void *context, SSD1306_ASYNC_CALLBACK callback, void *arg);
+RESULT SSD1306_GetAsyncStats(const void *context, SSD1306_ASYNC_STATS *stats);
+RESULT SSD1306_GetWindowStats(const void *context, SSD1306_WINDOW_STATS *stats);
+RESULT SSD1306_UpdateLanes(const void *context, const uint8_t *const *frames);
+RESULT SSD1306_RowsToPages(const uint8_t *rows, uint8_t width, uint8_t height, uint8_t *pages);
+RESULT SSD1306_PagesToRows(const uint8_t *pages, uint8_t width, uint8_t height, uint8_t *rows);
+RESULT SSD1306_Screenshot(const void *context, uint8_t *rows);
+
+#ifdef DEBUG
+RESULT SSD1306_BenchmarkTranspose(uint32_t iterations);
+#endif
 #endif // __ssd1306_h__ 
 
@@ -0,0 +1,244 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 by Hector Cura Jr.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Description:
+ *  Built-in fonts and font helpers. The 5x7 glyphs are the common ASCII 
+ *  0x20-0x7E set; the proportional variant shares them, pointing past each
+ *  glyph's blank leading columns and trimming its trailing ones.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+#include "result_codes.h"
+#include "i2c.h"
+#include "ssd1306.h"
+#include "ssd1306_font.h"
+
+static const uint8_t GLYPHS_5X7[] SSD1306_FONT_STORAGE = {
+    0x00, 0x00, 0x00, 0x00, 0x00,    // ' '
+    0x00, 0x00, 0x5F, 0x00, 0x00,    // '!'
+    0x00, 0x07, 0x00, 0x07, 0x00,    // '"'
+    0x14, 0x7F, 0x14, 0x7F, 0x14,    // '#'
+    0x24, 0x2A, 0x7F, 0x2A, 0x12,    // '$'
+    0x23, 0x13, 0x08, 0x64, 0x62,    // '%'
+    0x36, 0x49, 0x55, 0x22, 0x50,    // '&'
+    0x00, 0x05, 0x03, 0x00, 0x00,    // '''
+    0x00, 0x1C, 0x22, 0x41, 0x00,    // '('
+    0x00, 0x41, 0x22, 0x1C, 0x00,    // ')'
+    0x08, 0x2A, 0x1C, 0x2A, 0x08,    // '*'
+    0x08, 0x08, 0x3E, 0x08, 0x08,    // '+'
+    0x00, 0x50, 0x30, 0x00, 0x00,    // ','
+    0x08, 0x08, 0x08, 0x08, 0x08,    // '-'
+    0x00, 0x60, 0x60, 0x00, 0x00,    // '.'
+    0x20, 0x10, 0x08, 0x04, 0x02,    // '/'
+    0x3E, 0x51, 0x49, 0x45, 0x3E,    // '0'
+    0x00, 0x42, 0x7F, 0x40, 0x00,    // '1'
+    0x42, 0x61, 0x51, 0x49, 0x46,    // '2'
+    0x21, 0x41, 0x45, 0x4B, 0x31,    // '3'
+    0x18, 0x14, 0x12, 0x7F, 0x10,    // '4'
+    0x27, 0x45, 0x45, 0x45, 0x39,    // '5'
+    0x3C, 0x4A, 0x49, 0x49, 0x30,    // '6'
+    0x01, 0x71, 0x09, 0x05, 0x03,    // '7'
+    0x36, 0x49, 0x49, 0x49, 0x36,    // '8'
+    0x06, 0x49, 0x49, 0x29, 0x1E,    // '9'
+    0x00, 0x36, 0x36, 0x00, 0x00,    // ':'
+    0x00, 0x56, 0x36, 0x00, 0x00,    // ';'
+    0x08, 0x14, 0x22, 0x41, 0x00,    // '<'
+    0x14, 0x14, 0x14, 0x14, 0x14,    // '='
+    0x00, 0x41, 0x22, 0x14, 0x08,    // '>'
+    0x02, 0x01, 0x51, 0x09, 0x06,    // '?'
+    0x32, 0x49, 0x79, 0x41, 0x3E,    // '@'
+    0x7E, 0x11, 0x11, 0x11, 0x7E,    // 'A'
+    0x7F, 0x49, 0x49, 0x49, 0x36,    // 'B'
+    0x3E, 0x41, 0x41, 0x41, 0x22,    // 'C'
+    0x7F, 0x41, 0x41, 0x22, 0x1C,    // 'D'
+    0x7F, 0x49, 0x49, 0x49, 0x41,    // 'E'
+    0x7F, 0x09, 0x09, 0x01, 0x01,    // 'F'
+    0x3E, 0x41, 0x41, 0x51, 0x32,    // 'G'
+    0x7F, 0x08, 0x08, 0x08, 0x7F,    // 'H'
+    0x00, 0x41, 0x7F, 0x41, 0x00,    // 'I'
+    0x20, 0x40, 0x41, 0x3F, 0x01,    // 'J'
+    0x7F, 0x08, 0x14, 0x22, 0x41,    // 'K'
+    0x7F, 0x40, 0x40, 0x40, 0x40,    // 'L'
+    0x7F, 0x02, 0x04, 0x02, 0x7F,    // 'M'
+    0x7F, 0x04, 0x08, 0x10, 0x7F,    // 'N'
+    0x3E, 0x41, 0x41, 0x41, 0x3E,    // 'O'
+    0x7F, 0x09, 0x09, 0x09, 0x06,    // 'P'
+    0x3E, 0x41, 0x51, 0x21, 0x5E,    // 'Q'
+    0x7F, 0x09, 0x19, 0x29, 0x46,    // 'R'
+    0x46, 0x49, 0x49, 0x49, 0x31,    // 'S'
+    0x01, 0x01, 0x7F, 0x01, 0x01,    // 'T'
+    0x3F, 0x40, 0x40, 0x40, 0x3F,    // 'U'
+    0x1F, 0x20, 0x40, 0x20, 0x1F,    // 'V'
+    0x7F, 0x20, 0x18, 0x20, 0x7F,    // 'W'
+    0x63, 0x14, 0x08, 0x14, 0x63,    // 'X'
+    0x03, 0x04, 0x78, 0x04, 0x03,    // 'Y'
+    0x61, 0x51, 0x49, 0x45, 0x43,    // 'Z'
+    0x00, 0x7F, 0x41, 0x41, 0x00,    // '['
+    0x02, 0x04, 0x08, 0x10, 0x20,    // '\\'
+    0x00, 0x41, 0x41, 0x7F, 0x00,    // ']'
+    0x04, 0x02, 0x01, 0x02, 0x04,    // '^'
+    0x40, 0x40, 0x40, 0x40, 0x40,    // '_'
+    0x00, 0x01, 0x02, 0x04, 0x00,    // '`'
+    0x20, 0x54, 0x54, 0x54, 0x78,    // 'a'
+    0x7F, 0x48, 0x44, 0x44, 0x38,    // 'b'
+    0x38, 0x44, 0x44, 0x44, 0x20,    // 'c'
+    0x38, 0x44, 0x44, 0x48, 0x7F,    // 'd'
+    0x38, 0x54, 0x54, 0x54, 0x18,    // 'e'
+    0x08, 0x7E, 0x09, 0x01, 0x02,    // 'f'
+    0x08, 0x14, 0x54, 0x54, 0x3C,    // 'g'
+    0x7F, 0x08, 0x04, 0x04, 0x78,    // 'h'
+    0x00, 0x44, 0x7D, 0x40, 0x00,    // 'i'
+    0x20, 0x40, 0x44, 0x3D, 0x00,    // 'j'
+    0x00, 0x7F, 0x10, 0x28, 0x44,    // 'k'
+    0x00, 0x41, 0x7F, 0x40, 0x00,    // 'l'
+    0x7C, 0x04, 0x18, 0x04, 0x78,    // 'm'
+    0x7C, 0x08, 0x04, 0x04, 0x78,    // 'n'
+    0x38, 0x44, 0x44, 0x44, 0x38,    // 'o'
+    0x7C, 0x14, 0x14, 0x14, 0x08,    // 'p'
+    0x08, 0x14, 0x14, 0x18, 0x7C,    // 'q'
+    0x7C, 0x08, 0x04, 0x04, 0x08,    // 'r'
+    0x48, 0x54, 0x54, 0x54, 0x20,    // 's'
+    0x04, 0x3F, 0x44, 0x40, 0x20,    // 't'
+    0x3C, 0x40, 0x40, 0x20, 0x7C,    // 'u'
+    0x1C, 0x20, 0x40, 0x20, 0x1C,    // 'v'
+    0x3C, 0x40, 0x30, 0x40, 0x3C,    // 'w'
+    0x44, 0x28, 0x10, 0x28, 0x44,    // 'x'
+    0x0C, 0x50, 0x50, 0x50, 0x3C,    // 'y'
+    0x44, 0x64, 0x54, 0x4C, 0x44,    // 'z'
+    0x00, 0x08, 0x36, 0x41, 0x00,    // '{'
+    0x00, 0x00, 0x7F, 0x00, 0x00,    // '|'
+    0x00, 0x41, 0x36, 0x08, 0x00,    // '}'
+    0x08, 0x04, 0x08, 0x10, 0x08     // '~'
+};
+
+static const uint8_t WIDTHS_5X7_PROP[] SSD1306_FONT_STORAGE = {
+    2, 1, 3, 5, 5, 5, 5, 2, 3, 3, 5, 5, 2, 5, 2, 5,
+    5, 3, 5, 5, 5, 5, 5, 5, 5, 5, 2, 2, 4, 5, 4, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 5, 3, 5, 5,
+    3, 5, 5, 5, 5, 5, 5, 5, 5, 3, 4, 4, 3, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 1, 3, 5
+};
+
+static const uint16_t OFFSETS_5X7_PROP[] SSD1306_FONT_STORAGE = {
+      0,   7,  11,  15,  20,  25,  30,  36,  41,  46,  50,  55,  61,  65,  71,  75,
+     80,  86,  90,  95, 100, 105, 110, 115, 120, 125, 131, 136, 140, 145, 151, 155,
+    160, 165, 170, 175, 180, 185, 190, 195, 200, 206, 210, 215, 220, 225, 230, 235,
+    240, 245, 250, 255, 260, 265, 270, 275, 280, 285, 290, 296, 300, 306, 310, 315,
+    321, 325, 330, 335, 340, 345, 350, 355, 360, 366, 370, 376, 381, 385, 390, 395,
+    400, 405, 410, 415, 420, 425, 430, 435, 440, 445, 450, 456, 462, 466, 470
+};
+
+const SSD1306_FONT SSD1306_FONT_5X7 = {
+    .height      = 7,
+    .firstChar   = 0x20,
+    .lastChar    = 0x7E,
+    .defaultChar = '?',
+    .width       = 5,
+    .spacing     = 1,
+    .widths      = NULL,
+    .offsets     = NULL,
+    .bitmap      = GLYPHS_5X7
+};
+
+const SSD1306_FONT SSD1306_FONT_5X7_PROP = {
+    .height      = 7,
+    .firstChar   = 0x20,
+    .lastChar    = 0x7E,
+    .defaultChar = '?',
+    .width       = 0,
+    .spacing     = 1,
+    .widths      = WIDTHS_5X7_PROP,
+    .offsets     = OFFSETS_5X7_PROP,
+    .bitmap      = GLYPHS_5X7
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to read a byte of font data with an aligned 32-bit load,
+ * which, unlike a byte load, is allowed from flash.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+uint8_t
+SSD1306_FontReadByte(const uint8_t *p)
+{
+    uint32_t word = *(const uint32_t *)((uintptr_t)p & ~(uintptr_t)3);
+    return (uint8_t)(word >> (8 * ((uintptr_t)p & 3)));
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to find a glyph. Characters outside the font map to its
+ * defaultChar.
+ *
+ *  OUTPUT
+ *      columns - first byte of the glyph's page 0 columns; page p starts
+ *                p * width bytes further on.
+ *      returns the glyph's width in columns, 0 if the font has no glyph.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+uint8_t
+SSD1306_FontGlyph(const SSD1306_FONT *font, char c, const uint8_t **columns)
+{
+    uint8_t code = (uint8_t)c;
+    if ((code < font->firstChar) || (code > font->lastChar)) {
+        code = font->defaultChar;
+        if ((code < font->firstChar) || (code > font->lastChar)) {
+            return 0;
+        }
+    }
+
+    uint8_t index = code - font->firstChar;
+    if (font->widths == NULL) {
+        uint8_t pages = (font->height + 7) / 8;
+        *columns = font->bitmap + (index * font->width * pages);
+        return font->width;
+    }
+
+    const uint8_t *offset = (const uint8_t *)&font->offsets[index];
+    *columns = font->bitmap + (SSD1306_FontReadByte(offset) | (SSD1306_FontReadByte(offset + 1) << 8));
+    return SSD1306_FontReadByte(&font->widths[index]);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to measure text in columns, spacing between glyphs 
+ * included, trailing spacing not.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+uint16_t
+SSD1306_MeasureText(const SSD1306_FONT *font, const char *text)
+{
+    if ((font == NULL) || (text == NULL)) {
+        return 0;
+    }
+
+    uint16_t width = 0;
+    for (; *text != '\0'; text++) {
+        const uint8_t *columns;
+        uint8_t glyphWidth = SSD1306_FontGlyph(font, *text, &columns);
+        if (glyphWidth > 0) {
+            width += glyphWidth + font->spacing;
+        }
+    }
+
+    return (width > 0) ? width - font->spacing : 0;
+}
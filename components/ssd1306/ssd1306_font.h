@@ -0,0 +1,68 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 by Hector Cura Jr.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Description:
+ *  Bitmap fonts in SSD1306 page format. A glyph is stored page-major: its
+ *  columns for page 0 (rows 0-7, LSB on top), then its columns for page 1,
+ *  so a glyph drawn on a page boundary is copied byte for byte. Bitmaps,
+ *  widths and offsets are read with aligned 32-bit loads, so they may be 
+ *  placed in flash by defining SSD1306_FONT_STORAGE.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _ssd1306_font_h__
+#define _ssd1306_font_h__
+
+#define SSD1306_FONT_MAX_HEIGHT     16
+#define SSD1306_FONT_MAX_WIDTH      16
+#define SSD1306_FONT_MAX_PAGES      ((SSD1306_FONT_MAX_HEIGHT + 7) / 8)
+
+#ifndef SSD1306_FONT_STORAGE
+#define SSD1306_FONT_STORAGE        __attribute__((aligned(4)))
+#endif
+
+typedef struct _SSD1306_FONT {
+    uint8_t         height;         // rows, 1 to SSD1306_FONT_MAX_HEIGHT.
+    uint8_t         firstChar;
+    uint8_t         lastChar;
+    uint8_t         defaultChar;    // drawn for characters outside [firstChar, lastChar].
+    uint8_t         width;          // glyph width when widths is NULL (monospace).
+    uint8_t         spacing;        // blank columns after each glyph.
+    const uint8_t   *widths;        // proportional: width of each glyph, or NULL.
+    const uint16_t  *offsets;       // proportional: offset of each glyph in bitmap, or NULL.
+    const uint8_t   *bitmap;
+}SSD1306_FONT;
+
+extern const SSD1306_FONT SSD1306_FONT_5X7;         // monospace, 21 characters per line.
+extern const SSD1306_FONT SSD1306_FONT_5X7_PROP;    // same glyphs, blank columns trimmed.
+
+uint8_t SSD1306_FontGlyph(const SSD1306_FONT *font, char c, const uint8_t **columns);
+uint16_t SSD1306_MeasureText(const SSD1306_FONT *font, const char *text);
+uint8_t SSD1306_FontReadByte(const uint8_t *p);
+
+RESULT SSD1306_DrawText(const void *context, const POINT origin, const SSD1306_FONT *font, const char *text,
+                        SSD1306_DRAW_MODE mode);
+
+RESULT SSD1306_ConsoleOpen(const void *context, const SSD1306_FONT *font);
+RESULT SSD1306_ConsoleWrite(const void *context, const char *text);
+RESULT SSD1306_ConsoleClose(const void *context);
+
+#endif // _ssd1306_font_h__ 
@@ -0,0 +1,478 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 by Hector Cura Jr.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Description:
+ *  Mock transport: an in-memory SSD1306 that decodes the command stream 
+ *  and writes data into a 1KB GDDRAM image, so rendering and window 
+ *  logic can be checked without a panel. Horizontal, vertical and page
+ *  addressing are emulated; other commands are parsed for their argument
+ *  count and otherwise ignored, apart from display on/off, inversion,
+ *  contrast, scrolling, the start line and the effects which are 
+ *  reported by SSD1306_MockGetStats(). With PERF_STATS_ENABLED every 
+ *  transaction is a START/STOP pair and its command and data bytes are 
+ *  counted, matching commandBytes + dataBytes.
+ *  Horizontal scroll steps are applied on request, see 
+ *  SSD1306_MockScrollStep().
+ *  host/Makefile builds it with the driver on Linux, see host/host_main.c.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+#include "esp_log.h"
+#include "result_codes.h"
+#include "i2c.h"
+#include "ssd1306.h"
+#include "ssd1306_transport.h"
+#include "timer_util.h"
+#include "perf_stats.h"
+
+#define MOCK_PAGES          8
+#define MOCK_MAX_ARGS       6
+
+typedef enum {
+    MODE_HORIZONTAL = 0,
+    MODE_VERTICAL   = 1,
+    MODE_PAGE       = 2
+}addressing_mode_t;
+
+typedef struct _mock_link_t {
+    uint32_t    header;
+    uint8_t     gddram[MOCK_PAGES][SSD1306_WIDTH];
+    addressing_mode_t mode;
+    uint8_t     colStart, colEnd, col;
+    uint8_t     pageStart, pageEnd, page;
+    uint8_t     cmd;                        // command awaiting arguments.
+    uint8_t     argsNeeded;
+    uint8_t     argCount;
+    uint8_t     args[MOCK_MAX_ARGS];
+    uint8_t     scrollCmd;                  // last 0x26/0x27/0x29/0x2A, 0 before any.
+    uint8_t     scrollStart, scrollEnd;     // pages it moves.
+    SSD1306_MOCK_STATS stats;
+#if PERF_STATS_ENABLED
+    uint32_t    perfStart;                  // cycle count at START, for bus-busy time.
+#endif
+}mock_link_t;
+
+static const char *MOCK_TAG = "SSD1306_MOCK";
+
+static RESULT mockSendCommands(void *link, const uint8_t *cmds, size_t length);
+static RESULT mockSendData(void *link, const I2C_BUFFER *buffers, size_t count);
+static RESULT mockSendCommandsAndData(void *link, const uint8_t *cmds, size_t length, 
+                                      const I2C_BUFFER *buffers, size_t count);
+static RESULT mockSetBusSpeed(void *link, I2C_BUS_SPEED speed);
+static RESULT mockFreeLink(void **link);
+static uint8_t argumentCount(uint8_t cmd);
+static RESULT runCommands(mock_link_t *ptr, const uint8_t *cmds, size_t length);
+static void runData(mock_link_t *ptr, const I2C_BUFFER *buffers, size_t count);
+static void execute(mock_link_t *ptr, uint8_t cmd, const uint8_t *args);
+static void writeByte(mock_link_t *ptr, uint8_t data);
+
+const SSD1306_TRANSPORT SSD1306_MOCK_TRANSPORT = {
+    .name                = "mock",
+    .commandOverhead     = 2,                    // priced like the I2C framing it emulates
+    .sendCommands        = mockSendCommands,
+    .sendData            = mockSendData,
+    .sendCommandsAndData = mockSendCommandsAndData,
+    .setBusSpeed         = mockSetBusSpeed,
+    .freeLink            = mockFreeLink
+};
+
+#define ASSIGN_LINK(p, l, f) \
+    p = (mock_link_t *)l; \
+    if ((p == NULL) || (p->header != (uint32_t)p)) { \
+        ESP_LOGE(MOCK_TAG, "%s(): Invalid link.", f); \
+        return INVALID_CONTEXT; \
+    }
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to create a mock panel in its power-on reset state. The link
+ * is handed to SSD1306_InitializeTransport().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT 
+SSD1306_MockOpen(void **link)
+{
+    if (link == NULL) {
+        ESP_LOGE(MOCK_TAG, "SSD1306_MockOpen(): link cannot be NULL.");
+        return INVALID_ARGUMENT;
+    }
+
+    mock_link_t *ptr = (mock_link_t *)calloc(1, sizeof(mock_link_t));
+    if (ptr == NULL) {
+        ESP_LOGE(MOCK_TAG, "SSD1306_MockOpen(): Failed to allocate memory for link!");
+        return FAILED_TO_ALLOCATE_MEMORY;
+    }
+
+    ptr->header         = (uint32_t)ptr;
+    ptr->mode           = MODE_PAGE;
+    ptr->colEnd         = SSD1306_WIDTH - 1;
+    ptr->pageEnd        = MOCK_PAGES - 1;
+    ptr->stats.contrast = 0x7F;
+    *link = ptr;
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to read the emulated GDDRAM, page-major: byte 
+ * [page * SSD1306_WIDTH + column] holds rows page*8 (LSB) to page*8+7.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+const uint8_t *
+SSD1306_MockGetGDDRAM(const void *link)
+{
+    const mock_link_t *ptr = (const mock_link_t *)link;
+    if ((ptr == NULL) || (ptr->header != (uint32_t)ptr)) {
+        ESP_LOGE(MOCK_TAG, "SSD1306_MockGetGDDRAM(): Invalid link.");
+        return NULL;
+    }
+
+    return &ptr->gddram[0][0];
+}
+
+RESULT 
+SSD1306_MockGetStats(const void *link, SSD1306_MOCK_STATS *stats)
+{
+    mock_link_t *ptr;
+    ASSIGN_LINK(ptr, link, "SSD1306_MockGetStats");
+
+    if (stats == NULL) {
+        return INVALID_ARGUMENT;
+    }
+
+    *stats = ptr->stats;
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to zero the transaction and byte counters; panel state 
+ * (display on, inversion, contrast) is kept.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT 
+SSD1306_MockResetStats(void *link)
+{
+    mock_link_t *ptr;
+    ASSIGN_LINK(ptr, link, "SSD1306_MockResetStats");
+
+    ptr->stats.commandXmits = 0;
+    ptr->stats.dataXmits    = 0;
+    ptr->stats.mixedXmits   = 0;
+    ptr->stats.commandBytes = 0;
+    ptr->stats.dataBytes    = 0;
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to advance an active horizontal scroll by one column, as the
+ * controller does every scroll interval: the scrolled pages' GDDRAM rotates
+ * right (0x26, 0x29) or left (0x27, 0x2A). Vertical offsets only move the
+ * picture, not GDDRAM, so they are not emulated.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_MockScrollStep(void *link)
+{
+    mock_link_t *ptr;
+    ASSIGN_LINK(ptr, link, "SSD1306_MockScrollStep");
+
+    if (!ptr->stats.scrolling || (ptr->scrollCmd == 0)) {
+        return OK;
+    }
+
+    const bool right = (ptr->scrollCmd == 0x26) || (ptr->scrollCmd == 0x29);
+    for (uint8_t page = ptr->scrollStart; page <= ptr->scrollEnd; page++) {
+        uint8_t *row = ptr->gddram[page];
+        if (right) {
+            uint8_t last = row[SSD1306_WIDTH - 1];
+            memmove(row + 1, row, SSD1306_WIDTH - 1);
+            row[0] = last;
+        } else {
+            uint8_t first = row[0];
+            memmove(row, row + 1, SSD1306_WIDTH - 1);
+            row[SSD1306_WIDTH - 1] = first;
+        }
+    }
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Transport methods.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+mockSendCommands(void *link, const uint8_t *cmds, size_t length) 
+{
+    mock_link_t *ptr;
+    ASSIGN_LINK(ptr, link, "sendCommands");
+
+    ptr->stats.commandXmits++;
+    PERF_BUS_START(ptr->perfStart);
+    RESULT ret = runCommands(ptr, cmds, length);
+    PERF_BUS_STOP(ptr->perfStart);
+    return ret;
+}
+
+static RESULT
+mockSendData(void *link, const I2C_BUFFER *buffers, size_t count) 
+{
+    mock_link_t *ptr;
+    ASSIGN_LINK(ptr, link, "sendData");
+
+    ptr->stats.dataXmits++;
+    PERF_BUS_START(ptr->perfStart);
+    runData(ptr, buffers, count);
+    PERF_BUS_STOP(ptr->perfStart);
+    return OK;
+}
+
+static RESULT
+mockSendCommandsAndData(void *link, const uint8_t *cmds, size_t length, const I2C_BUFFER *buffers, size_t count) 
+{
+    mock_link_t *ptr;
+    ASSIGN_LINK(ptr, link, "sendCommandsAndData");
+
+    ptr->stats.mixedXmits++;
+    PERF_BUS_START(ptr->perfStart);
+    RESULT ret = runCommands(ptr, cmds, length);
+    if (ret == OK) {
+        runData(ptr, buffers, count);
+    }
+    PERF_BUS_STOP(ptr->perfStart);
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to decode a command list. Arguments follow their command 
+ * within the list, a new transaction starts with a command.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+runCommands(mock_link_t *ptr, const uint8_t *cmds, size_t length)
+{
+    ptr->stats.commandBytes += length;
+    PERF_COUNT_BYTES(length);
+
+    ptr->argsNeeded = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (ptr->argsNeeded == 0) {
+            ptr->cmd        = cmds[i];
+            ptr->argsNeeded = argumentCount(cmds[i]);
+            ptr->argCount   = 0;
+        } else {
+            ptr->args[ptr->argCount++] = cmds[i];
+            ptr->argsNeeded--;
+        }
+
+        if (ptr->argsNeeded == 0) {
+            execute(ptr, ptr->cmd, ptr->args);
+        }
+    }
+
+    if (ptr->argsNeeded != 0) {
+        ESP_LOGE(MOCK_TAG, "runCommands(): Command 0x%02x is missing %d argument(s).", ptr->cmd, ptr->argsNeeded);
+        return INVALID_ARGUMENT;
+    }
+
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to write a data stream into GDDRAM.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+runData(mock_link_t *ptr, const I2C_BUFFER *buffers, size_t count) 
+{
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < buffers[i].length; j++) {
+            writeByte(ptr, buffers[i].data[j]);
+        }
+        ptr->stats.dataBytes += buffers[i].length;
+        PERF_COUNT_BYTES(buffers[i].length);
+    }
+}
+
+static RESULT
+mockSetBusSpeed(void *link, I2C_BUS_SPEED speed)
+{
+    mock_link_t *ptr;
+    ASSIGN_LINK(ptr, link, "setBusSpeed");
+
+    return OK;
+}
+
+static RESULT
+mockFreeLink(void **link)
+{
+    if (link == NULL) {
+        return INVALID_ARGUMENT;
+    }
+
+    mock_link_t *ptr;
+    ASSIGN_LINK(ptr, *link, "freeLink");
+
+    ptr->header = 0;
+    free(ptr);
+    *link = NULL;
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method returning how many argument bytes follow a command.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static uint8_t
+argumentCount(uint8_t cmd)
+{
+    switch (cmd) {
+        case 0x20:      // memory addressing mode
+        case 0x23:      // fade out / blink
+        case 0x81:      // contrast
+        case 0x8D:      // charge pump
+        case 0xA8:      // multiplex ratio
+        case 0xD3:      // display offset
+        case 0xD5:      // clock divide
+        case 0xD6:      // zoom in
+        case 0xD9:      // pre-charge period
+        case 0xDA:      // COM pins
+        case 0xDB:      // VCOMH deselect level
+            return 1;
+        case 0x21:      // column address
+        case 0x22:      // page address
+        case 0xA3:      // vertical scroll area
+            return 2;
+        case 0x29:      // vertical and right horizontal scroll
+        case 0x2A:      // vertical and left horizontal scroll
+            return 5;
+        case 0x26:      // right horizontal scroll
+        case 0x27:      // left horizontal scroll
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to apply a complete command.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+execute(mock_link_t *ptr, uint8_t cmd, const uint8_t *args)
+{
+    if ((cmd >= 0xB0) && (cmd <= 0xB7)) {
+        if (ptr->mode == MODE_PAGE) {
+            ptr->page = cmd & 0x07;
+        }
+        return;
+    }
+
+    if (cmd <= 0x1F) {
+        if (ptr->mode == MODE_PAGE) {
+            ptr->col = (cmd < 0x10) ? ((ptr->col & 0xF0) | (cmd & 0x0F))
+                                    : ((ptr->col & 0x0F) | ((cmd & 0x07) << 4));
+        }
+        return;
+    }
+
+    if ((cmd & 0xC0) == 0x40) {
+        ptr->stats.startLine = cmd & 0x3F;
+        return;
+    }
+
+    switch (cmd) {
+        case 0x20:
+            if ((args[0] & 0x03) != 0x03) {
+                ptr->mode = (addressing_mode_t)(args[0] & 0x03);
+            }
+            break;
+        case 0x21:
+            ptr->colStart = args[0] & 0x7F;
+            ptr->colEnd   = args[1] & 0x7F;
+            ptr->col      = ptr->colStart;
+            break;
+        case 0x22:
+            ptr->pageStart = args[0] & 0x07;
+            ptr->pageEnd   = args[1] & 0x07;
+            ptr->page      = ptr->pageStart;
+            break;
+        case 0x26:
+        case 0x27:
+        case 0x29:
+        case 0x2A:
+            ptr->scrollCmd   = cmd;
+            ptr->scrollStart = args[1] & 0x07;
+            ptr->scrollEnd   = args[3] & 0x07;
+            break;
+        case 0x2E:
+        case 0x2F:
+            ptr->stats.scrolling = cmd & 0x01;
+            break;
+        case 0x23:
+            ptr->stats.fade = args[0];
+            break;
+        case 0x81:
+            ptr->stats.contrast = args[0];
+            break;
+        case 0xA4:
+        case 0xA5:
+            ptr->stats.entireOn = cmd & 0x01;
+            break;
+        case 0xA6:
+        case 0xA7:
+            ptr->stats.inverted = cmd & 0x01;
+            break;
+        case 0xAE:
+        case 0xAF:
+            ptr->stats.displayOn = cmd & 0x01;
+            break;
+        case 0xD6:
+            ptr->stats.zoomed = args[0] & 0x01;
+            break;
+        default:
+            break;
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to store a data byte and advance the pointers as the 
+ * controller does for the current addressing mode.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+writeByte(mock_link_t *ptr, uint8_t data)
+{
+    ptr->gddram[ptr->page][ptr->col] = data;
+
+    switch (ptr->mode) {
+        case MODE_HORIZONTAL:
+            if (ptr->col++ >= ptr->colEnd) {
+                ptr->col = ptr->colStart;
+                ptr->page = (ptr->page >= ptr->pageEnd) ? ptr->pageStart : ptr->page + 1;
+            }
+            break;
+        case MODE_VERTICAL:
+            if (ptr->page++ >= ptr->pageEnd) {
+                ptr->page = ptr->pageStart;
+                ptr->col = (ptr->col >= ptr->colEnd) ? ptr->colStart : ptr->col + 1;
+            }
+            break;
+        case MODE_PAGE:
+        default:
+            // The page is not incremented, the column wraps within it.
+            ptr->col = (ptr->col + 1) & (SSD1306_WIDTH - 1);
+            break;
+    }
+}
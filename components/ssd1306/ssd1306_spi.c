@@ -0,0 +1,263 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 by Hector Cura Jr.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Description:
+ *  4-wire SPI transport for the SSD1306 on the ESP8266 HSPI peripheral.
+ *  SCLK is GPIO14, MOSI GPIO13 and CS GPIO15; D/C# and RES# are any free
+ *  GPIO. D/C# is LOW for a command stream and HIGH for a data stream, so 
+ *  no control bytes are sent. The HSPI FIFO holds 64 bytes, which bounds
+ *  each spi_trans() call; a stream is sent as back-to-back FIFO loads.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "driver/spi.h"
+
+#include "esp_log.h"
+#include "result_codes.h"
+#include "i2c.h"
+#include "ssd1306_transport.h"
+
+#define SPI_FIFO_BYTES      64
+#define SPI_MAX_CLOCK_MHZ   10
+
+typedef struct _spi_link_t {
+    uint32_t    header;
+    uint8_t     dcPin;
+    uint8_t     resetPin;
+    uint32_t    fifo[SPI_FIFO_BYTES/sizeof(uint32_t)];  // spi_trans() reads words.
+}spi_link_t;
+
+static const char *SPI_TAG = "SSD1306_SPI";
+
+static spi_link_t *OPEN_LINK = NULL;                    // HSPI has one owner.
+
+static RESULT spiSendCommands(void *link, const uint8_t *cmds, size_t length);
+static RESULT spiSendData(void *link, const I2C_BUFFER *buffers, size_t count);
+static RESULT spiSetBusSpeed(void *link, I2C_BUS_SPEED speed);
+static RESULT spiFreeLink(void **link);
+static RESULT writeStream(spi_link_t *ptr, uint32_t dcLevel, const I2C_BUFFER *buffers, size_t count);
+static RESULT writeFifo(spi_link_t *ptr, size_t length);
+
+const SSD1306_TRANSPORT SSD1306_SPI_TRANSPORT = {
+    .name                = "spi",
+    .commandOverhead     = 0,                    // D/C# selects commands, no framing bytes
+    .sendCommands        = spiSendCommands,
+    .sendData            = spiSendData,
+    .sendCommandsAndData = NULL,                 // no address byte to save, D/C# splits the stream anyway
+    .setBusSpeed         = spiSetBusSpeed,
+    .freeLink            = spiFreeLink
+};
+
+#define ASSIGN_LINK(p, l, f) \
+    p = (spi_link_t *)l; \
+    if ((p == NULL) || (p->header != (uint32_t)p)) { \
+        ESP_LOGE(SPI_TAG, "%s(): Invalid link.", f); \
+        return INVALID_CONTEXT; \
+    }
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Public method to claim HSPI and the D/C# (and RES#) pins, and reset the
+ * panel. The link is handed to SSD1306_InitializeTransport().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT 
+SSD1306_SpiOpen(const SSD1306_SPI_CONFIG *config, void **link)
+{
+    if ((config == NULL) || (link == NULL)) {
+        ESP_LOGE(SPI_TAG, "SSD1306_SpiOpen(): config and link cannot be NULL.");
+        return INVALID_ARGUMENT;
+    }
+
+    if ((config->clockMHz == 0) || (config->clockMHz > SPI_MAX_CLOCK_MHZ)) {
+        ESP_LOGE(SPI_TAG, "SSD1306_SpiOpen(): clockMHz must be 1-%d.", SPI_MAX_CLOCK_MHZ);
+        return INVALID_ARGUMENT;
+    }
+
+    if (!GPIO_IS_VALID_GPIO(config->dcPin) ||
+        ((config->resetPin != SSD1306_SPI_NO_PIN) && !GPIO_IS_VALID_GPIO(config->resetPin))) {
+        ESP_LOGE(SPI_TAG, "SSD1306_SpiOpen(): Invalid D/C# or RES# pin.");
+        return INVALID_ARGUMENT;
+    }
+
+    if (OPEN_LINK != NULL) {
+        ESP_LOGE(SPI_TAG, "SSD1306_SpiOpen(): HSPI is already in use.");
+        return FAILED_TO_CONFIGURE_SPI;
+    }
+
+    gpio_config_t io_conf = {0};
+    io_conf.pin_bit_mask = (1ULL << config->dcPin);
+    if (config->resetPin != SSD1306_SPI_NO_PIN) {
+        io_conf.pin_bit_mask |= (1ULL << config->resetPin);
+    }
+    io_conf.mode         = GPIO_MODE_OUTPUT;
+    io_conf.pull_up_en   = GPIO_PULLUP_DISABLE;
+    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    io_conf.intr_type    = GPIO_INTR_DISABLE;
+    if (gpio_config(&io_conf) != ESP_OK) {
+        ESP_LOGE(SPI_TAG, "SSD1306_SpiOpen(): Failed to configure D/C# or RES# pin.");
+        return FAILED_TO_CONFIGURE_SPI;
+    }
+
+    // Mode 0, MSB first, hardware CS. byte_tx_order = 0 puts the lowest 
+    // addressed byte of each FIFO word on the wire first.
+    spi_config_t spi_conf = {0};
+    spi_conf.interface.val   = SPI_DEFAULT_INTERFACE;
+    spi_conf.interface.miso_en = 0;
+    spi_conf.intr_enable.val = SPI_MASTER_DEFAULT_INTR_ENABLE;
+    spi_conf.event_cb        = NULL;
+    spi_conf.mode            = SPI_MASTER_MODE;
+    spi_conf.clk_div         = (spi_clk_div_t)(80 / config->clockMHz);
+    if (spi_init(HSPI_HOST, &spi_conf) != ESP_OK) {
+        ESP_LOGE(SPI_TAG, "SSD1306_SpiOpen(): spi_init() failed.");
+        return FAILED_TO_CONFIGURE_SPI;
+    }
+
+    spi_link_t *ptr = (spi_link_t *)malloc(sizeof(spi_link_t));
+    if (ptr == NULL) {
+        ESP_LOGE(SPI_TAG, "SSD1306_SpiOpen(): Failed to allocate memory for link!");
+        spi_deinit(HSPI_HOST);
+        return FAILED_TO_ALLOCATE_MEMORY;
+    }
+
+    ptr->header   = (uint32_t)ptr;
+    ptr->dcPin    = config->dcPin;
+    ptr->resetPin = config->resetPin;
+
+    // RES# LOW for at least 3us, then the controller needs a few us more.
+    if (ptr->resetPin != SSD1306_SPI_NO_PIN) {
+        gpio_set_level(ptr->resetPin, 0);
+        vTaskDelay(1);
+        gpio_set_level(ptr->resetPin, 1);
+        vTaskDelay(1);
+    }
+
+    OPEN_LINK = ptr;
+    *link = ptr;
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Transport methods.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+spiSendCommands(void *link, const uint8_t *cmds, size_t length) 
+{
+    spi_link_t *ptr;
+    ASSIGN_LINK(ptr, link, "sendCommands");
+
+    const I2C_BUFFER buffer = { cmds, length };
+    return writeStream(ptr, 0, &buffer, 1);
+}
+
+static RESULT
+spiSendData(void *link, const I2C_BUFFER *buffers, size_t count) 
+{
+    spi_link_t *ptr;
+    ASSIGN_LINK(ptr, link, "sendData");
+
+    return writeStream(ptr, 1, buffers, count);
+}
+
+static RESULT
+spiSetBusSpeed(void *link, I2C_BUS_SPEED speed)
+{
+    // The clock is fixed by SSD1306_SPI_CONFIG.clockMHz.
+    return NOT_IMPLEMENTED;
+}
+
+static RESULT
+spiFreeLink(void **link)
+{
+    if (link == NULL) {
+        return INVALID_ARGUMENT;
+    }
+
+    spi_link_t *ptr;
+    ASSIGN_LINK(ptr, *link, "freeLink");
+
+    spi_deinit(HSPI_HOST);
+    OPEN_LINK = NULL;
+    ptr->header = 0;
+    free(ptr);
+    *link = NULL;
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to set D/C# and pack the buffers into FIFO loads. 
+ * spi_trans() blocks until each load is shifted out, and CS is released
+ * between loads, which the SSD1306 tolerates mid-stream.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+writeStream(spi_link_t *ptr, uint32_t dcLevel, const I2C_BUFFER *buffers, size_t count)
+{
+    gpio_set_level(ptr->dcPin, dcLevel);
+
+    uint8_t *fifo = (uint8_t *)ptr->fifo;
+    size_t fill = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *src = buffers[i].data;
+        size_t remaining = buffers[i].length;
+
+        while (remaining > 0) {
+            size_t n = SPI_FIFO_BYTES - fill;
+            if (n > remaining) {
+                n = remaining;
+            }
+            memcpy(fifo + fill, src, n);
+            fill += n;
+            src += n;
+            remaining -= n;
+
+            if (fill == SPI_FIFO_BYTES) {
+                RESULT ret = writeFifo(ptr, fill);
+                if (ret != OK) {
+                    return ret;
+                }
+                fill = 0;
+            }
+        }
+    }
+
+    return (fill > 0) ? writeFifo(ptr, fill) : OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to shift out the first length bytes of the FIFO buffer.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+writeFifo(spi_link_t *ptr, size_t length)
+{
+    spi_trans_t trans = {0};
+    trans.mosi      = ptr->fifo;
+    trans.bits.mosi = length * 8;
+    if (spi_trans(HSPI_HOST, &trans) != ESP_OK) {
+        ESP_LOGE(SPI_TAG, "writeFifo(): spi_trans() failed.");
+        return FAILED_WRITE;
+    }
+
+    return OK;
+}
@@ -0,0 +1,91 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 by Hector Cura Jr.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _ssd1306_transport_h__
+#define _ssd1306_transport_h__
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Transport: how command and data streams reach the panel. The display 
+ * serializes calls with its bus lock, so implementations need no locking
+ * of their own. link is the transport's own context.
+ * sendCommandsAndData is optional: commands followed by a data stream in a
+ * single transaction, each command behind its own control byte. When NULL 
+ * the two are sent separately.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef struct _SSD1306_TRANSPORT {
+    const char *name;
+    uint8_t    commandOverhead;     // bytes a sendCommands transaction adds to its commands.
+    RESULT (*sendCommands)(void *link, const uint8_t *cmds, size_t length);
+    RESULT (*sendData)(void *link, const I2C_BUFFER *buffers, size_t count);
+    RESULT (*sendCommandsAndData)(void *link, const uint8_t *cmds, size_t length, 
+                                  const I2C_BUFFER *buffers, size_t count);
+    RESULT (*setBusSpeed)(void *link, I2C_BUS_SPEED speed);
+    RESULT (*freeLink)(void **link);
+}SSD1306_TRANSPORT;
+
+extern const SSD1306_TRANSPORT SSD1306_I2C_TRANSPORT;     // bit-banged I2C, see SSD1306_Initialize().
+extern const SSD1306_TRANSPORT SSD1306_SPI_TRANSPORT;     // 4-wire SPI on HSPI.
+extern const SSD1306_TRANSPORT SSD1306_MOCK_TRANSPORT;    // in-memory GDDRAM, no hardware.
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 4-wire SPI: SCLK GPIO14, MOSI GPIO13, CS GPIO15 (HSPI hardware pins).
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#define SSD1306_SPI_NO_PIN  0xFF
+
+typedef struct _SSD1306_SPI_CONFIG {
+    uint8_t     dcPin;          // D/C#: LOW for commands, HIGH for data.
+    uint8_t     resetPin;       // RES#, SSD1306_SPI_NO_PIN if tied HIGH.
+    uint8_t     clockMHz;       // 1-10, the SSD1306 serial clock cycle is 100ns minimum.
+}SSD1306_SPI_CONFIG;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Mock: counters of what reached the emulated controller.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef struct _SSD1306_MOCK_STATS {
+    uint32_t    commandXmits;   // sendCommands transactions.
+    uint32_t    dataXmits;      // sendData transactions.
+    uint32_t    mixedXmits;     // sendCommandsAndData transactions.
+    uint32_t    commandBytes;
+    uint32_t    dataBytes;
+    uint8_t     displayOn;      // last 0xAE/0xAF.
+    uint8_t     inverted;       // last 0xA6/0xA7.
+    uint8_t     contrast;       // last 0x81 argument.
+    uint8_t     scrolling;      // last 0x2E/0x2F.
+    uint8_t     startLine;      // last 0x40-0x7F, GDDRAM row shown at the top.
+    uint8_t     fade;           // last 0x23 argument.
+    uint8_t     entireOn;       // last 0xA4/0xA5.
+    uint8_t     zoomed;         // last 0xD6 argument.
+}SSD1306_MOCK_STATS;
+
+RESULT SSD1306_InitializeSPI(const SSD1306_SPI_CONFIG *config, uint8_t contrast, void **context);
+RESULT SSD1306_InitializeTransport(const SSD1306_TRANSPORT *transport, void *link, uint8_t contrast, void **context);
+
+RESULT SSD1306_SpiOpen(const SSD1306_SPI_CONFIG *config, void **link);
+
+RESULT SSD1306_MockOpen(void **link);
+const uint8_t *SSD1306_MockGetGDDRAM(const void *link);
+RESULT SSD1306_MockGetStats(const void *link, SSD1306_MOCK_STATS *stats);
+RESULT SSD1306_MockResetStats(void *link);
+RESULT SSD1306_MockScrollStep(void *link);
+
+#endif // _ssd1306_transport_h__ 
@@ -0,0 +1,308 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 by Hector Cura Jr.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Description:
+ *  Conversion between row-major 1bpp images and the SSD1306's page format.
+ *  Rows are XBM style: (width+7)/8 bytes per row, LSB is the leftmost pixel.
+ *  Pages are (height+7)/8 runs of width bytes, LSB is the top row, like PAGE
+ *  and the bitmaps SSD1306_Blit() takes. Both directions are the same 8x8 
+ *  bit-matrix transpose applied block by block.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "result_codes.h"
+#include "i2c.h"
+#include "timer_util.h"
+#include "ssd1306.h"
+
+static const char *TRANSPOSE_TAG = "SSD1306_TRANSPOSE";
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to transpose an 8x8 bit matrix: bit j of in[i] becomes bit i
+ * of out[j]. Rows of the matrix are istride/ostride bytes apart.
+ *
+ *  NOTE
+ *      Algo: the eight bytes are packed into two words, lo holding matrix 
+ *            rows 0-3 and hi rows 4-7, so bit (8*row + col) of the pair is
+ *            one pixel. Three delta swaps then exchange the off-diagonal 
+ *            2x2, 4x4 and 8x8 sub-blocks: bits 7 and 14 apart inside each 
+ *            word, then the nibbles between the two words.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static inline void
+transposeBlock(const uint8_t *in, size_t istride, uint8_t *out, size_t ostride)
+{
+    uint32_t lo = in[0] | (in[istride] << 8) | (in[2*istride] << 16) | ((uint32_t)in[3*istride] << 24);
+    uint32_t hi = in[4*istride] | (in[5*istride] << 8) | (in[6*istride] << 16) | ((uint32_t)in[7*istride] << 24);
+    uint32_t t;
+
+    t  = (lo ^ (lo >> 7)) & 0x00AA00AA;
+    lo ^= t ^ (t << 7);
+    t  = (hi ^ (hi >> 7)) & 0x00AA00AA;
+    hi ^= t ^ (t << 7);
+
+    t  = (lo ^ (lo >> 14)) & 0x0000CCCC;
+    lo ^= t ^ (t << 14);
+    t  = (hi ^ (hi >> 14)) & 0x0000CCCC;
+    hi ^= t ^ (t << 14);
+
+    t  = (lo & 0x0F0F0F0F) | ((hi << 4) & 0xF0F0F0F0);
+    hi = ((lo >> 4) & 0x0F0F0F0F) | (hi & 0xF0F0F0F0);
+    lo = t;
+
+    out[0]         = (uint8_t)lo;
+    out[ostride]   = (uint8_t)(lo >> 8);
+    out[2*ostride] = (uint8_t)(lo >> 16);
+    out[3*ostride] = (uint8_t)(lo >> 24);
+    out[4*ostride] = (uint8_t)hi;
+    out[5*ostride] = (uint8_t)(hi >> 8);
+    out[6*ostride] = (uint8_t)(hi >> 16);
+    out[7*ostride] = (uint8_t)(hi >> 24);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to convert a row-major 1bpp image into page format.
+ *
+ *  INPUT
+ *      rows   - height rows of SSD1306_ROW_STRIDE(width) bytes, LSB on the left.
+ *      pages  - receives (height+7)/8 pages of width bytes, LSB on top.
+ *               Rows past height in the last page come out clear.
+ *
+ *  NOTE
+ *      Full 8x8 blocks are transposed in place; the blocks on the right and
+ *      bottom edges go through a zero-padded copy so nothing past the
+ *      buffers is read or written.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_RowsToPages(const uint8_t *rows, uint8_t width, uint8_t height, uint8_t *pages)
+{
+    if ((rows == NULL) || (pages == NULL) || (width == 0) || (height == 0)) {
+        ESP_LOGE(TRANSPOSE_TAG, "SSD1306_RowsToPages(): rows and pages cannot be NULL, width and height must be > 0.");
+        return INVALID_ARGUMENT;
+    }
+
+    const size_t stride = SSD1306_ROW_STRIDE(width);
+
+    for (uint16_t row=0; row<height; row+=8) {
+        const uint8_t   rowCount = ((height - row) < 8) ? (height - row) : 8;
+        const uint8_t   *src     = rows + (row * stride);
+        uint8_t         *dst     = pages + ((row / 8) * width);
+
+        for (uint16_t block=0; block<stride; block++) {
+            const uint8_t colCount = ((width - block*8) < 8) ? (width - block*8) : 8;
+
+            if ((rowCount == 8) && (colCount == 8)) {
+                transposeBlock(src + block, stride, dst + block*8, 1);
+            } else {
+                uint8_t in[8] = {0};
+                uint8_t out[8];
+                for (uint8_t r=0; r<rowCount; r++) {
+                    in[r] = src[(r * stride) + block];
+                }
+                transposeBlock(in, 1, out, 1);
+                memcpy(dst + block*8, out, colCount);
+            }
+        }
+    }
+
+    return OK;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to convert a page-format image back into row-major 1bpp, 
+ * e.g. to save a screenshot of the framebuffer.
+ *
+ *  INPUT
+ *      pages  - (height+7)/8 pages of width bytes, LSB on top.
+ *      rows   - receives height rows of SSD1306_ROW_STRIDE(width) bytes, LSB
+ *               on the left. Padding bits past width come out clear.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_PagesToRows(const uint8_t *pages, uint8_t width, uint8_t height, uint8_t *rows)
+{
+    if ((pages == NULL) || (rows == NULL) || (width == 0) || (height == 0)) {
+        ESP_LOGE(TRANSPOSE_TAG, "SSD1306_PagesToRows(): pages and rows cannot be NULL, width and height must be > 0.");
+        return INVALID_ARGUMENT;
+    }
+
+    const size_t stride = SSD1306_ROW_STRIDE(width);
+
+    for (uint16_t row=0; row<height; row+=8) {
+        const uint8_t   rowCount = ((height - row) < 8) ? (height - row) : 8;
+        const uint8_t   *src     = pages + ((row / 8) * width);
+        uint8_t         *dst     = rows + (row * stride);
+
+        for (uint16_t block=0; block<stride; block++) {
+            const uint8_t colCount = ((width - block*8) < 8) ? (width - block*8) : 8;
+
+            if ((rowCount == 8) && (colCount == 8)) {
+                transposeBlock(src + block*8, 1, dst + block, stride);
+            } else {
+                uint8_t in[8] = {0};
+                uint8_t out[8];
+                memcpy(in, src + block*8, colCount);
+                transposeBlock(in, 1, out, 1);
+                for (uint8_t r=0; r<rowCount; r++) {
+                    dst[(r * stride) + block] = out[r];
+                }
+            }
+        }
+    }
+
+    return OK;
+}
+
+#ifdef DEBUG
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method, per-pixel reference for SSD1306_RowsToPages().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+rowsToPagesNaive(const uint8_t *rows, uint8_t width, uint8_t height, uint8_t *pages)
+{
+    const size_t stride = SSD1306_ROW_STRIDE(width);
+
+    memset(pages, 0, ((height + 7) / 8) * width);
+    for (uint8_t row=0; row<height; row++) {
+        for (uint8_t col=0; col<width; col++) {
+            if (rows[(row * stride) + (col / 8)] & (1 << (col % 8))) {
+                pages[((row / 8) * width) + col] |= (1 << (row % 8));
+            }
+        }
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Private method to check both conversions against the per-pixel reference 
+ * on a random image of the given size. Returns false on a mismatch or if the
+ * buffers cannot be allocated.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+checkTransposeSize(uint8_t width, uint8_t height)
+{
+    const size_t rowBytes  = SSD1306_ROW_STRIDE(width) * height;
+    const size_t pageBytes = ((height + 7) / 8) * width;
+    bool         match     = false;
+
+    uint8_t *rows  = (uint8_t *)malloc(rowBytes * 2);
+    uint8_t *pages = (uint8_t *)malloc(pageBytes * 2);
+    if ((rows != NULL) && (pages != NULL)) {
+        for (size_t x=0; x<rowBytes; x++) {
+            rows[x] = (uint8_t)esp_random();
+        }
+
+        // Padding bits past width do not survive the round trip.
+        if (width % 8) {
+            for (uint16_t row=0; row<height; row++) {
+                rows[((row + 1) * SSD1306_ROW_STRIDE(width)) - 1] &= (1 << (width % 8)) - 1;
+            }
+        }
+
+        rowsToPagesNaive(rows, width, height, pages + pageBytes);
+        SSD1306_RowsToPages(rows, width, height, pages);
+        SSD1306_PagesToRows(pages, width, height, rows + rowBytes);
+
+        match = (memcmp(pages, pages + pageBytes, pageBytes) == 0) && (memcmp(rows, rows + rowBytes, rowBytes) == 0);
+    }
+
+    free(rows);
+    free(pages);
+    return match;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Public method to time SSD1306_RowsToPages() against the per-pixel 
+ * reference on a random full frame, and check that both agree and that
+ * SSD1306_PagesToRows() gives the frame back. The same check then runs 
+ * over a sweep of sizes that exercise the partial edge blocks, up to 255.
+ *
+ *  OUTPUT
+ *      OK                          Results match.
+ *      FAILED_READ                 A conversion did not match the reference.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+RESULT
+SSD1306_BenchmarkTranspose(uint32_t iterations)
+{
+    const size_t rowBytes  = SSD1306_ROW_STRIDE(SSD1306_WIDTH) * SSD1306_HEIGHT;
+    const size_t pageBytes = (SSD1306_HEIGHT / 8) * SSD1306_WIDTH;
+
+    if (iterations == 0) {
+        ESP_LOGE(TRANSPOSE_TAG, "SSD1306_BenchmarkTranspose(): iterations must be > 0.");
+        return INVALID_ARGUMENT;
+    }
+
+    uint8_t *rows  = (uint8_t *)malloc(rowBytes * 2);
+    uint8_t *pages = (uint8_t *)malloc(pageBytes * 2);
+    if ((rows == NULL) || (pages == NULL)) {
+        free(rows);
+        free(pages);
+        ESP_LOGE(TRANSPOSE_TAG, "SSD1306_BenchmarkTranspose(): Failed to allocate memory for frames!");
+        return FAILED_TO_ALLOCATE_MEMORY;
+    }
+
+    for (size_t x=0; x<rowBytes; x++) {
+        rows[x] = (uint8_t)esp_random();
+    }
+
+    uint32_t start = getCCOUNT();
+    for (uint32_t i=0; i<iterations; i++) {
+        rowsToPagesNaive(rows, SSD1306_WIDTH, SSD1306_HEIGHT, pages + pageBytes);
+    }
+    uint32_t naive = getCCOUNT() - start;
+
+    start = getCCOUNT();
+    for (uint32_t i=0; i<iterations; i++) {
+        SSD1306_RowsToPages(rows, SSD1306_WIDTH, SSD1306_HEIGHT, pages);
+    }
+    uint32_t fast = getCCOUNT() - start;
+
+    SSD1306_PagesToRows(pages, SSD1306_WIDTH, SSD1306_HEIGHT, rows + rowBytes);
+
+    RESULT ret = OK;
+    if ((memcmp(pages, pages + pageBytes, pageBytes) != 0) || (memcmp(rows, rows + rowBytes, rowBytes) != 0)) {
+        ESP_LOGE(TRANSPOSE_TAG, "SSD1306_BenchmarkTranspose(): Transposed frame does not match the reference!");
+        ret = FAILED_READ;
+    }
+
+    static const uint8_t sizes[] = { 1, 7, 8, 9, 63, 64, 65, 127, 128, 249, 250, 255 };
+    for (size_t w=0; w<sizeof(sizes); w++) {
+        for (size_t h=0; h<sizeof(sizes); h++) {
+            if (!checkTransposeSize(sizes[w], sizes[h])) {
+                ESP_LOGE(TRANSPOSE_TAG, "SSD1306_BenchmarkTranspose(): %ux%u image does not match the reference!", sizes[w], sizes[h]);
+                ret = FAILED_READ;
+            }
+        }
+    }
+
+    ESP_LOGI(TRANSPOSE_TAG, "SSD1306_BenchmarkTranspose(): naive %u ticks/frame, 8x8 %u ticks/frame (%ux).",
+                            naive / iterations, fast / iterations, (fast != 0) ? (naive / fast) : 0);
+
+    free(rows);
+    free(pages);
+    return ret;
+}
+#endif
@@ -0,0 +1,696 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 by Hector Cura Jr.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Description:
+ *  Host build: runs the driver on Linux against the mock transport and 
+ *  checks what reaches GDDRAM. See host/Makefile.
+ *   - a seeded random replay of drawing calls without the framebuffer, 
+ *     hashing GDDRAM after every call. Builds with the window 
+ *     optimizations turned off must print the same hash.
+ *   - the same replay with the framebuffer, checking GDDRAM against it 
+ *     after every SSD1306_Flush().
+ *   - bytes and transactions each demo workload puts on the bus. The perf
+ *     variant checks the PERF_GetStats() bus counters against them, and 
+ *     the latency of every instrumented method against the transactions
+ *     it made, on the fake cycle counter.
+ *   - a proportional glyph wider than SSD1306_FONT_MAX_WIDTH, clipped.
+ *   - portrait pixels drawn one at a time against the same frame sent 
+ *     with SSD1306_UpdatePortrait().
+ *   - a contrast ramp driven by the timer stand-ins, and the transpose 
+ *     sweep of SSD1306_BenchmarkTranspose().
+ *   - cpu ticks per byte of i2c.c on the GPIO stand-in: I2C_Write() per 
+ *     byte against I2C_WriteBuffer() and I2C_WriteBuffers().
+ *  Exits non-zero if a check fails.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "driver/gpio.h"
+
+#include "result_codes.h"
+#include "i2c.h"
+#include "ssd1306.h"
+#include "ssd1306_transport.h"
+#include "ssd1306_font.h"
+#include "timer_util.h"
+#include "perf_stats.h"
+
+#define REPLAY_SEED         7
+#define REPLAY_CALLS        40000
+#define WORKLOAD_SEED       1
+#define PAGES               (SSD1306_HEIGHT / 8)
+#define FRAME_BYTES         (PAGES * SSD1306_WIDTH)
+#define I2C_ADDRESS         0x3C
+#define I2C_SCL             GPIO_NUM_5
+#define I2C_SDA             GPIO_NUM_4
+#define I2C_REPEATS         25
+#define PERF_CALLS          4000
+
+static uint8_t BITS[FRAME_BYTES];               // random page-format source for blits and page updates.
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Opens a mock panel and a display context on it.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+openDisplay(void **mock, void **display)
+{
+    if ((SSD1306_MockOpen(mock) != OK) || 
+        (SSD1306_InitializeTransport(&SSD1306_MOCK_TRANSPORT, *mock, 0x7F, display) != OK)) {
+        printf("FAIL: cannot open the mock display.\n");
+        return false;
+    }
+    return true;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Makes one random drawing call. Invert, AND and XOR need the framebuffer
+ * and are only used with it.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+randomCall(void *display, bool framebuffer)
+{
+    const POINT a = { rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH };
+    const POINT b = { rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH };
+    const SSD1306_DRAW_MODE mode = (SSD1306_DRAW_MODE)(rand() % (framebuffer ? 3 : 2));
+    const SSD1306_BLIT_OP   op   = (SSD1306_BLIT_OP)(rand() % (framebuffer ? 4 : 2));
+
+    switch (rand() % 11) {
+    case 0: 
+    case 1: 
+    case 2: 
+        return SSD1306_DrawPixel(display, a.row, a.col);
+    case 3: {
+        RESULT ret = OK;
+        for (uint8_t x=0; (x<8) && (ret == OK); x++) {
+            ret = SSD1306_DrawPixel(display, a.row, (a.col + x) % SSD1306_WIDTH);
+        }
+        return ret;
+    }
+    case 4: 
+        return SSD1306_DrawLine(display, a, b);
+    case 5: 
+        return SSD1306_DrawRectangle(display, a, b, rand() % 2, mode);
+    case 6: 
+        return SSD1306_DrawCircle(display, a, rand() % 20, rand() % 2, mode);
+    case 7: 
+        return SSD1306_DrawText(display, a, (rand() % 2) ? &SSD1306_FONT_5X7 : &SSD1306_FONT_5X7_PROP, "Hi 12", mode);
+    case 8: 
+        return SSD1306_Blit(display, a, 1 + rand() % 40, 1 + rand() % 30, BITS, NULL, op);
+    case 9: 
+        return ((rand() % 20) == 0) ? SSD1306_FillDisplay(display, (uint8_t)rand()) : OK;
+    default: {
+        if ((rand() % 20) != 0) {
+            return OK;
+        }
+        uint8_t first = rand() % PAGES;
+        return SSD1306_UpdatePages(display, first, 1 + rand() % (PAGES - first), (const PAGE *)BITS);
+    }
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Replays REPLAY_CALLS random calls without the framebuffer and hashes 
+ * GDDRAM after each, so a difference anywhere along the way shows.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+replayDirect(uint32_t *hash)
+{
+    void *mock, *display;
+    if (!openDisplay(&mock, &display)) {
+        return false;
+    }
+
+    srand(REPLAY_SEED);
+    *hash = 0;
+    for (uint32_t n=0; n<REPLAY_CALLS; n++) {
+        RESULT ret = randomCall(display, false);
+        if (ret != OK) {
+            printf("FAIL: replay call %u returned %d.\n", n, ret);
+            return false;
+        }
+
+        const uint8_t *gddram = SSD1306_MockGetGDDRAM(mock);
+        for (uint32_t x=0; x<FRAME_BYTES; x++) {
+            *hash = (*hash * 31) + gddram[x];
+        }
+    }
+
+    SSD1306_FreeContext(&display);
+    return true;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Replays REPLAY_CALLS random calls into the framebuffer, flushing after 
+ * each, and checks that GDDRAM then matches the framebuffer.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+replayFramebuffer(void)
+{
+    static uint8_t rows[SSD1306_ROW_STRIDE(SSD1306_WIDTH) * SSD1306_HEIGHT];
+    static uint8_t pages[FRAME_BYTES];
+
+    void *mock, *display;
+    if (!openDisplay(&mock, &display) || (SSD1306_EnableFramebuffer(display, true) != OK)) {
+        return false;
+    }
+
+    srand(REPLAY_SEED);
+    for (uint32_t n=0; n<REPLAY_CALLS; n++) {
+        RESULT ret = randomCall(display, true);
+        if (ret == OK) {
+            ret = SSD1306_Flush(display);
+        }
+        if (ret != OK) {
+            printf("FAIL: framebuffer replay call %u returned %d.\n", n, ret);
+            return false;
+        }
+
+        SSD1306_Screenshot(display, rows);
+        SSD1306_RowsToPages(rows, SSD1306_WIDTH, SSD1306_HEIGHT, pages);
+        if (memcmp(pages, SSD1306_MockGetGDDRAM(mock), FRAME_BYTES) != 0) {
+            printf("FAIL: GDDRAM differs from the framebuffer after call %u.\n", n);
+            return false;
+        }
+    }
+
+    SSD1306_FreeContext(&display);
+    return true;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Draws a two-page proportional glyph wider than SSD1306_FONT_MAX_WIDTH and
+ * checks that both pages are read at the glyph's own width and clipped.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+checkWideGlyph(void)
+{
+    #define WIDE_GLYPH  (SSD1306_FONT_MAX_WIDTH + 4)
+    static uint8_t        wideBitmap[2 * WIDE_GLYPH] __attribute__((aligned(4)));
+    static const uint8_t  wideWidths[4] __attribute__((aligned(4))) = { WIDE_GLYPH };
+    static const uint16_t wideOffsets[2] __attribute__((aligned(4))) = { 0 };
+    static const SSD1306_FONT wide = { 16, 'A', 'A', 'A', 0, 1, wideWidths, wideOffsets, wideBitmap };
+    static uint8_t rows[SSD1306_ROW_STRIDE(SSD1306_WIDTH) * SSD1306_HEIGHT];
+    static uint8_t pages[FRAME_BYTES];
+
+    for (uint8_t x=0; x<WIDE_GLYPH; x++) {
+        wideBitmap[x]              = x + 1;                 // page 0
+        wideBitmap[WIDE_GLYPH + x] = 0x80 | x;              // page 1
+    }
+
+    void *mock, *display;
+    if (!openDisplay(&mock, &display)) {
+        return false;
+    }
+
+    const POINT origin = { 0, 0 };
+    bool passed = (SSD1306_EnableFramebuffer(display, true) == OK) && (SSD1306_ClearDisplay(display) == OK) &&
+                  (SSD1306_DrawText(display, origin, &wide, "AA", SSD1306_DRAW_SET) == OK);
+
+    SSD1306_Screenshot(display, rows);
+    SSD1306_RowsToPages(rows, SSD1306_WIDTH, SSD1306_HEIGHT, pages);
+    for (uint8_t x=0; passed && (x<SSD1306_FONT_MAX_WIDTH); x++) {
+        passed = (pages[x] == x + 1) && (pages[SSD1306_WIDTH + x] == (0x80 | x)) &&
+                 (pages[SSD1306_FONT_MAX_WIDTH + 1 + x] == x + 1);
+    }
+    passed = passed && (pages[SSD1306_FONT_MAX_WIDTH] == 0);
+
+    if (!passed) {
+        printf("FAIL: wide glyph is not clipped to %d columns.\n", SSD1306_FONT_MAX_WIDTH);
+    }
+
+    SSD1306_FreeContext(&display);
+    return passed;
+    #undef WIDE_GLYPH
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Turns two displays to portrait, draws a random frame pixel by pixel into 
+ * the framebuffer of one and sends it whole to the other, and checks that 
+ * GDDRAM matches. Text is laid out in pages and must be refused.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+checkPortrait(void)
+{
+    const uint8_t stride = SSD1306_ROW_STRIDE(SSD1306_PORTRAIT_WIDTH);
+    static uint8_t rows[SSD1306_ROW_STRIDE(SSD1306_PORTRAIT_WIDTH) * SSD1306_PORTRAIT_HEIGHT];
+
+    void *drawnMock, *drawn, *sentMock, *sent;
+    if (!openDisplay(&drawnMock, &drawn) || !openDisplay(&sentMock, &sent)) {
+        return false;
+    }
+
+    bool passed = (SSD1306_EnableFramebuffer(drawn, true) == OK) &&
+                  (SSD1306_SetRotation(drawn, SSD1306_ROTATE_90, false, false) == OK) &&
+                  (SSD1306_SetRotation(sent, SSD1306_ROTATE_90, false, false) == OK) &&
+                  (SSD1306_ClearDisplay(drawn) == OK);
+
+    srand(REPLAY_SEED);
+    for (uint32_t x=0; x<sizeof(rows); x++) {
+        rows[x] = (uint8_t)rand();
+    }
+    for (uint8_t row=0; passed && (row<SSD1306_PORTRAIT_HEIGHT); row++) {
+        for (uint8_t col=0; passed && (col<SSD1306_PORTRAIT_WIDTH); col++) {
+            if ((rows[(row * stride) + (col / 8)] >> (col & 7)) & 1) {
+                passed = (SSD1306_DrawPixel(drawn, row, col) == OK);
+            }
+        }
+    }
+    passed = passed && (SSD1306_Flush(drawn) == OK) && (SSD1306_UpdatePortrait(sent, rows) == OK) &&
+             (memcmp(SSD1306_MockGetGDDRAM(drawnMock), SSD1306_MockGetGDDRAM(sentMock), FRAME_BYTES) == 0);
+
+    const POINT origin = { 0, 0 };
+    passed = passed && 
+             (SSD1306_DrawText(drawn, origin, &SSD1306_FONT_5X7, "Hi", SSD1306_DRAW_SET) == INVALID_STATE_CHANGE_REQUEST);
+
+    if (!passed) {
+        printf("FAIL: portrait pixels do not match the portrait frame.\n");
+    }
+
+    SSD1306_FreeContext(&drawn);
+    SSD1306_FreeContext(&sent);
+    return passed;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Zeroes the mock counters, and the perf counters in the perf variant.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+resetStats(void *mock)
+{
+    SSD1306_MockResetStats(mock);
+#if PERF_STATS_ENABLED
+    PERF_ResetStats();
+#endif
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Prints what one workload put on the bus since the last call. The perf 
+ * variant fails it unless PERF_GetStats() saw the same bytes and one 
+ * START/STOP per transaction, each 1us busy on the fake counter.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+reportWorkload(void *mock, const char *name)
+{
+    SSD1306_MOCK_STATS stats;
+    SSD1306_MockGetStats(mock, &stats);
+    const uint32_t xmits = stats.commandXmits + stats.dataXmits + stats.mixedXmits;
+    printf("  %-22s %8u %8u %8u\n", name, stats.commandBytes, stats.dataBytes, xmits);
+
+    bool passed = true;
+#if PERF_STATS_ENABLED
+    PERF_STATS perf;
+    PERF_GetStats(&perf);
+    passed = (perf.bytes == stats.commandBytes + stats.dataBytes) && (perf.starts == xmits) && 
+             (perf.stops == xmits) && (perf.busyUs == xmits) && (perf.nacks == 0);
+    if (!passed) {
+        printf("FAIL: perf counted %u bytes, %u START/%u STOP, %u us busy for %s.\n", 
+                perf.bytes, perf.starts, perf.stops, (uint32_t)perf.busyUs, name);
+    }
+#endif
+
+    resetStats(mock);
+    return passed;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Runs the app_main drawing workloads and prints the command bytes, data 
+ * bytes and transactions of each, to compare builds.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+reportWorkloads(void)
+{
+    void *mock, *display;
+    if (!openDisplay(&mock, &display)) {
+        return false;
+    }
+
+    printf("  %-22s %8s %8s %8s\n", "workload", "cmd B", "data B", "xmits");
+    resetStats(mock);
+    srand(WORKLOAD_SEED);
+
+    bool passed = true;
+
+    for (uint8_t col=0; col<SSD1306_WIDTH; col++) {
+        SSD1306_DrawPixel(display, 32, col);
+    }
+    for (uint8_t col=0; col<SSD1306_WIDTH; col+=2) {
+        SSD1306_DrawPixel(display, 33, col);
+    }
+    passed = reportWorkload(mock, "pixel rows") && passed;
+
+    for (uint32_t n=0; n<1000; n++) {
+        SSD1306_DrawPixel(display, rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH);
+    }
+    passed = reportWorkload(mock, "1000 random pixels") && passed;
+
+    for (uint32_t n=0; n<1000; n++) {
+        const POINT a = { rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH };
+        const POINT b = { rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH };
+        SSD1306_DrawLine(display, a, b);
+    }
+    passed = reportWorkload(mock, "1000 random lines") && passed;
+
+    for (uint32_t n=0; n<200; n++) {
+        const POINT a = { rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH };
+        const POINT b = { rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH };
+        SSD1306_DrawRectangle(display, a, b, false, SSD1306_DRAW_SET);
+    }
+    passed = reportWorkload(mock, "200 rectangles") && passed;
+
+    for (uint32_t n=0; n<200; n++) {
+        const POINT center = { rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH };
+        SSD1306_DrawCircle(display, center, rand() % 20, false, SSD1306_DRAW_SET);
+    }
+    passed = reportWorkload(mock, "200 circles") && passed;
+
+    char line[22];
+    for (uint32_t frame=0; frame<30; frame++) {
+        for (uint8_t x=0; x<PAGES; x++) {
+            snprintf(line, sizeof(line), "Line %u frame %-4u %c", x, frame, "|/-\\"[frame & 3]);
+            SSD1306_DrawText(display, (POINT){ 8*x, 0 }, &SSD1306_FONT_5X7, line, SSD1306_DRAW_SET);
+        }
+    }
+    passed = reportWorkload(mock, "240 text lines") && passed;
+
+    SSD1306_EnableFramebuffer(display, true);
+    resetStats(mock);
+    for (uint32_t frame=0; frame<50; frame++) {
+        for (uint32_t n=0; n<20; n++) {
+            SSD1306_DrawPixel(display, rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH);
+        }
+        SSD1306_Flush(display);
+    }
+    passed = reportWorkload(mock, "50 fb frames x20 px") && passed;
+    SSD1306_EnableFramebuffer(display, false);
+
+    resetStats(mock);
+    SSD1306_ConsoleOpen(display, &SSD1306_FONT_5X7);
+    for (uint32_t n=0; n<40; n++) {
+        snprintf(line, sizeof(line), "log %2u: tick %u\n", n, n*7);
+        SSD1306_ConsoleWrite(display, line);
+    }
+    SSD1306_ConsoleClose(display);
+    passed = reportWorkload(mock, "console 40 lines") && passed;
+
+    SSD1306_WINDOW_STATS stats;
+    SSD1306_GetWindowStats(display, &stats);
+    printf("  windows %u, skipped %u, shrunk %u, mixed %u, page mode %u, mode switches %u\n", 
+            stats.windows, stats.skipped, stats.shrunk, stats.mixed, stats.pageMode, stats.modeSwitches);
+
+    SSD1306_FreeContext(&display);
+    return passed;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Contrast ramp callback: records the result.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void
+onRampDone(void *arg, RESULT result)
+{
+    *(RESULT *)arg = result;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Ramps the contrast down on the timer stand-ins and checks that it ends at
+ * the target, on time, with its callback.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+checkContrastRamp(void)
+{
+    void *mock, *display;
+    if (!openDisplay(&mock, &display)) {
+        return false;
+    }
+
+    RESULT done = NOT_IMPLEMENTED;
+    SSD1306_MOCK_STATS stats;
+    bool passed = (SSD1306_StartContrastRamp(display, 0, 500, onRampDone, &done) == OK);
+
+    HOST_AdvanceTicks(pdMS_TO_TICKS(500) - 1);
+    SSD1306_MockGetStats(mock, &stats);
+    passed = passed && (done == NOT_IMPLEMENTED) && (stats.contrast > 0);
+
+    HOST_AdvanceTicks(1);
+    SSD1306_MockGetStats(mock, &stats);
+    passed = passed && (done == OK) && (stats.contrast == 0);
+
+    if (!passed) {
+        printf("FAIL: contrast ramp ended at %u, callback result %d.\n", stats.contrast, done);
+    }
+
+    SSD1306_FreeContext(&display);
+    return passed;
+}
+
+#if PERF_STATS_ENABLED
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Calls instrumented method api once with random arguments.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static RESULT
+callApi(void *display, const PERF_API api)
+{
+    const POINT a = { rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH };
+    const POINT b = { rand() % SSD1306_HEIGHT, rand() % SSD1306_WIDTH };
+    const uint8_t first = rand() % PAGES;
+
+    switch (api) {
+    case PERF_FILL_DISPLAY:
+        return SSD1306_FillDisplay(display, (uint8_t)rand());
+    case PERF_UPDATE_PAGE:
+        return SSD1306_UpdatePages(display, first, 1 + rand() % (PAGES - first), (const PAGE *)BITS);
+    case PERF_DRAW_LINE:
+        return SSD1306_DrawLine(display, a, b);
+    case PERF_DRAW_PIXEL:
+        return SSD1306_DrawPixel(display, a.row, a.col);
+    case PERF_DRAW_RECTANGLE:
+        return SSD1306_DrawRectangle(display, a, b, rand() % 2, SSD1306_DRAW_SET);
+    case PERF_DRAW_CIRCLE:
+        return SSD1306_DrawCircle(display, a, rand() % 20, rand() % 2, SSD1306_DRAW_SET);
+    case PERF_FLUSH:
+        return SSD1306_Flush(display);
+    default:
+        return SSD1306_ConsoleWrite(display, (rand() % 2) ? "perf\n" : "stats ");
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Makes PERF_CALLS random instrumented calls, the second half with the 
+ * framebuffer, and checks PERF_GetStats() against what was called. On the
+ * fake counter a call with n transactions takes 2n+1 us: one read for each
+ * START and STOP and one to end the scope, so the expected histogram 
+ * follows from the mock's transaction count around each call.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+checkPerfLatency(void)
+{
+    void *mock, *display;
+    if (!openDisplay(&mock, &display) || (SSD1306_ConsoleOpen(display, &SSD1306_FONT_5X7) != OK)) {
+        return false;
+    }
+
+    PERF_LATENCY expected[PERF_API_COUNT];
+    memset(expected, 0, sizeof(expected));
+    srand(WORKLOAD_SEED);
+    resetStats(mock);
+
+    bool passed = true;
+    for (uint32_t n=0; (n < PERF_CALLS) && passed; n++) {
+        if (n == PERF_CALLS / 2) {
+            passed = (SSD1306_EnableFramebuffer(display, true) == OK);
+        }
+
+        SSD1306_MOCK_STATS before, after;
+        SSD1306_MockGetStats(mock, &before);
+        const PERF_API api = (PERF_API)(rand() % PERF_API_COUNT);
+        passed = passed && (callApi(display, api) == OK);
+        SSD1306_MockGetStats(mock, &after);
+
+        const uint32_t xmits = (after.commandXmits + after.dataXmits + after.mixedXmits) - 
+                               (before.commandXmits + before.dataXmits + before.mixedXmits);
+        const uint32_t us = (2 * xmits) + 1;
+        const uint32_t bucket = 32 - __builtin_clz(us);
+
+        PERF_LATENCY *latency = &expected[api];
+        latency->calls++;
+        latency->totalUs += us;
+        latency->buckets[(bucket < PERF_HISTOGRAM_BUCKETS) ? bucket : PERF_HISTOGRAM_BUCKETS-1]++;
+        if (us > latency->maxUs) {
+            latency->maxUs = us;
+        }
+    }
+
+    SSD1306_MOCK_STATS stats;
+    SSD1306_MockGetStats(mock, &stats);
+    PERF_STATS perf;
+    PERF_GetStats(&perf);
+    passed = passed && (perf.bytes == stats.commandBytes + stats.dataBytes) &&
+             (perf.starts == stats.commandXmits + stats.dataXmits + stats.mixedXmits);
+
+    for (uint32_t x=0; (x < PERF_API_COUNT) && passed; x++) {
+        passed = (expected[x].calls > 0) && (memcmp(&perf.api[x], &expected[x], sizeof(expected[x])) == 0);
+        if (!passed) {
+            printf("FAIL: perf API %u: %u calls, %u us total, %u us max, expected %u, %u, %u.\n", x, 
+                    perf.api[x].calls, (uint32_t)perf.api[x].totalUs, perf.api[x].maxUs, 
+                    expected[x].calls, (uint32_t)expected[x].totalUs, expected[x].maxUs);
+        }
+    }
+
+    if (passed) {
+        printf("Perf latencies of %u calls match the fake counter.\n", PERF_CALLS);
+    }
+
+    SSD1306_FreeContext(&display);
+    return passed;
+}
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Ways of sending a frame over I2C, see timeI2CWrite().
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+typedef enum { I2C_BY_BYTE, I2C_BY_BUFFER, I2C_BY_BUFFERS, I2C_METHODS }I2C_METHOD;
+
+static const char *I2C_METHOD_NAMES[I2C_METHODS] = {
+    [I2C_BY_BYTE]    = "I2C_Write()",
+    [I2C_BY_BUFFER]  = "I2C_WriteBuffer()",
+    [I2C_BY_BUFFERS] = "I2C_WriteBuffers()"
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Sends BITS in one transaction and returns the cpu ticks spent between START
+ * and STOP, or 0 if a call failed or a byte went missing. I2C_BY_BUFFERS 
+ * sends one buffer per page.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static uint32_t
+timeI2CWrite(void *i2c, const I2C_METHOD method)
+{
+    I2C_BUFFER pages[PAGES];
+    for (uint32_t x=0; x<PAGES; x++) {
+        pages[x].data   = BITS + (x * SSD1306_WIDTH);
+        pages[x].length = SSD1306_WIDTH;
+    }
+
+    size_t   sent = 0;
+    RESULT   ret  = I2C_StartXmit(i2c);
+    uint32_t start = getCCOUNT();
+    switch (method) {
+        case I2C_BY_BYTE:
+            for (; (sent < FRAME_BYTES) && (ret == OK); sent++) {
+                ret = I2C_Write(i2c, BITS[sent]);
+            }
+            break;
+        case I2C_BY_BUFFER:
+            ret = (ret == OK) ? I2C_WriteBuffer(i2c, BITS, FRAME_BYTES, &sent) : ret;
+            break;
+        default:
+            ret = (ret == OK) ? I2C_WriteBuffers(i2c, pages, PAGES, &sent) : ret;
+            break;
+    }
+    uint32_t ticks = getCCOUNT() - start;
+
+    RESULT stop = I2C_StopXmit(i2c);
+    return ((ret == OK) && (stop == OK) && (sent == FRAME_BYTES)) ? ticks : 0;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Runs i2c.c on the GPIO stand-in at I2C_SPEED_MAX, where only the bit kernel
+ * and the per-call overhead are left, and checks that a buffer write costs no
+ * more per byte than calling I2C_Write() for each one. The best of 
+ * I2C_REPEATS interleaved runs is kept, so a preempted run doesn't count.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static bool
+checkI2CWrites(void)
+{
+    void *i2c;
+    RESULT ret = I2C_Initialize(I2C_ADDRESS, I2C_SCL, I2C_SDA, I2C_ACK_NONE, I2C_SPEED_MAX, &i2c);
+    if (ret != OK) {
+        printf("FAIL: cannot open I2C on the GPIO stand-in, error %d.\n", ret);
+        return false;
+    }
+
+    uint32_t best[I2C_METHODS] = {0};
+    bool passed = true;
+    for (uint32_t r=0; (r < I2C_REPEATS) && passed; r++) {
+        for (uint32_t m=0; m<I2C_METHODS; m++) {
+            uint32_t ticks = timeI2CWrite(i2c, (I2C_METHOD)m);
+            passed = passed && (ticks != 0);
+            if ((best[m] == 0) || (ticks < best[m])) {
+                best[m] = ticks;
+            }
+        }
+    }
+    I2C_FreeContext(&i2c);
+
+    if (!passed) {
+        printf("FAIL: an I2C write did not send all %u bytes.\n", FRAME_BYTES);
+        return false;
+    }
+
+    printf("I2C ticks/byte, %u bytes at I2C_SPEED_MAX:", FRAME_BYTES);
+    for (uint32_t m=0; m<I2C_METHODS; m++) {
+        printf(" %s %u.%02u%s", I2C_METHOD_NAMES[m], best[m] / FRAME_BYTES, 
+               ((best[m] % FRAME_BYTES) * 100) / FRAME_BYTES, (m + 1 < I2C_METHODS) ? "," : "\n");
+    }
+
+    if ((best[I2C_BY_BUFFER] > best[I2C_BY_BYTE]) || (best[I2C_BY_BUFFERS] > best[I2C_BY_BYTE])) {
+        printf("FAIL: a buffer write is slower per byte than I2C_Write().\n");
+        return false;
+    }
+    return true;
+}
+
+int
+main(void)
+{
+    uint32_t hash   = 0;
+    int      failed = 0;
+
+    for (uint32_t x=0; x<FRAME_BYTES; x++) {
+        BITS[x] = (uint8_t)rand();
+    }
+
+    printf("Workloads:\n");
+    failed += !reportWorkloads();
+
+    failed += !replayDirect(&hash);
+    printf("Replay of %u calls without the framebuffer: gddram %08x\n", REPLAY_CALLS, hash);
+
+    failed += !replayFramebuffer();
+    failed += !checkWideGlyph();
+    failed += !checkPortrait();
+    failed += !checkContrastRamp();
+#if PERF_STATS_ENABLED
+    failed += !checkPerfLatency();
+#endif
+    failed += !checkI2CWrites();
+
+    if (SSD1306_BenchmarkTranspose(10) != OK) {
+        printf("FAIL: transpose does not match the reference.\n");
+        failed++;
+    }
+
+    printf("%s\n", (failed == 0) ? "PASS" : "FAIL");
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
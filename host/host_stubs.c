@@ -0,0 +1,326 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 by Hector Cura Jr.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Description:
+ *  Host build: single-task stand-ins for the FreeRTOS, GPIO and SPI calls
+ *  the drivers make, so that they run on Linux against the mock 
+ *  transport. See host/Makefile.
+ *  Nothing blocks: a take or receive that would wait fails instead. 
+ *  Tasks cannot be created, so async mode is unavailable. Software timers
+ *  expire as the tick count advances, see HOST_AdvanceTicks(). i2c.c 
+ *  bit-bangs a GPIO register block in memory with no slave on it, so its
+ *  transfers run at CPU speed and only I2C_ACK_NONE completes. There is no
+ *  SPI hardware; opening it fails.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include <string.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include "driver/gpio.h"
+#include "driver/spi.h"
+#include "esp8266/gpio_struct.h"
+
+#include "esp_system.h"
+#include "result_codes.h"
+#include "timer_util.h"
+
+struct _host_queue_t {
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t     items[];
+};
+
+struct _host_semaphore_t {
+    UBaseType_t count;                          // available takes; holds for a recursive mutex.
+    bool        recursive;
+};
+
+struct _host_timer_t {
+    struct _host_timer_t *next;
+    TickType_t  period;
+    TickType_t  expiry;
+    bool        autoReload;
+    bool        active;
+    void        *id;
+    TimerCallbackFunction_t callback;
+};
+
+static TickType_t    TICKS  = 0;
+static TimerHandle_t TIMERS = NULL;
+static uint32_t      CYCLES = 0;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Queues.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+QueueHandle_t 
+xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    QueueHandle_t queue = (QueueHandle_t)calloc(1, sizeof(*queue) + (length * itemSize));
+    if (queue != NULL) {
+        queue->length   = length;
+        queue->itemSize = itemSize;
+    }
+    return queue;
+}
+
+BaseType_t 
+xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait)
+{
+    if (queue->count == queue->length) {
+        return pdFAIL;
+    }
+
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->items + (tail * queue->itemSize), item, queue->itemSize);
+    queue->count++;
+    return pdPASS;
+}
+
+BaseType_t 
+xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait)
+{
+    if (queue->count == 0) {
+        return pdFALSE;
+    }
+
+    memcpy(item, queue->items + (queue->head * queue->itemSize), queue->itemSize);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdTRUE;
+}
+
+UBaseType_t 
+uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
+
+void 
+vQueueDelete(QueueHandle_t queue)
+{
+    free(queue);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Semaphores. With one task a mutex is always free unless the caller itself
+ * holds it, which only a recursive mutex allows.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static SemaphoreHandle_t
+createSemaphore(UBaseType_t count, bool recursive)
+{
+    SemaphoreHandle_t sem = (SemaphoreHandle_t)calloc(1, sizeof(*sem));
+    if (sem != NULL) {
+        sem->count     = count;
+        sem->recursive = recursive;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)          { return createSemaphore(1, false); }
+SemaphoreHandle_t xSemaphoreCreateBinary(void)         { return createSemaphore(0, false); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) { return createSemaphore(0, true); }
+
+BaseType_t 
+xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait)
+{
+    if (sem->count == 0) {
+        return pdFALSE;
+    }
+
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t 
+xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if (sem->count != 0) {
+        return pdFALSE;
+    }
+
+    sem->count++;
+    return pdTRUE;
+}
+
+BaseType_t 
+xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t wait)
+{
+    sem->count++;
+    return pdTRUE;
+}
+
+BaseType_t 
+xSemaphoreGiveRecursive(SemaphoreHandle_t sem)
+{
+    if (sem->count == 0) {
+        return pdFALSE;
+    }
+
+    sem->count--;
+    return pdTRUE;
+}
+
+void 
+vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    free(sem);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Tasks. vTaskDelay() advances the tick count, so timers run during it.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+BaseType_t 
+xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *arg, 
+            UBaseType_t priority, TaskHandle_t *task)
+{
+    return pdFAIL;
+}
+
+void         vTaskDelete(TaskHandle_t task)              { }
+void         vTaskDelay(TickType_t ticks)                { HOST_AdvanceTicks(ticks); }
+TickType_t   xTaskGetTickCount(void)                     { return TICKS; }
+TaskHandle_t xTaskGetCurrentTaskHandle(void)             { return NULL; }
+UBaseType_t  uxTaskPriorityGet(TaskHandle_t task)        { return 1; }
+void         vTaskSuspendAll(void)                       { }
+BaseType_t   xTaskResumeAll(void)                        { return pdFALSE; }
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Software timers.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+TimerHandle_t 
+xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload, void *id, 
+             TimerCallbackFunction_t callback)
+{
+    TimerHandle_t timer = (TimerHandle_t)calloc(1, sizeof(*timer));
+    if (timer != NULL) {
+        timer->period     = period;
+        timer->autoReload = (autoReload != pdFALSE);
+        timer->id         = id;
+        timer->callback   = callback;
+        timer->next       = TIMERS;
+        TIMERS = timer;
+    }
+    return timer;
+}
+
+BaseType_t 
+xTimerStart(TimerHandle_t timer, TickType_t wait)
+{
+    timer->active = true;
+    timer->expiry = TICKS + timer->period;
+    return pdPASS;
+}
+
+BaseType_t 
+xTimerStop(TimerHandle_t timer, TickType_t wait)
+{
+    timer->active = false;
+    return pdPASS;
+}
+
+BaseType_t 
+xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t wait)
+{
+    timer->period = period;
+    return xTimerStart(timer, wait);
+}
+
+BaseType_t 
+xTimerDelete(TimerHandle_t timer, TickType_t wait)
+{
+    for (TimerHandle_t *link = &TIMERS; *link != NULL; link = &(*link)->next) {
+        if (*link == timer) {
+            *link = timer->next;
+            free(timer);
+            return pdPASS;
+        }
+    }
+    return pdFAIL;
+}
+
+void *
+pvTimerGetTimerID(TimerHandle_t timer)
+{
+    return timer->id;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Advances the tick count one tick at a time, running the callbacks of the
+ * timers that expire on each tick. Callbacks must not delete their timer.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+void 
+HOST_AdvanceTicks(TickType_t ticks)
+{
+    while (ticks-- > 0) {
+        TICKS++;
+        for (TimerHandle_t timer = TIMERS; timer != NULL; timer = timer->next) {
+            if (timer->active && (timer->expiry == TICKS)) {
+                timer->active = timer->autoReload;
+                timer->expiry = TICKS + timer->period;
+                timer->callback(timer);
+            }
+        }
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * GPIO and HSPI. Pins are bits in GPIO and always configure; an ISR is 
+ * accepted but nothing ever raises it.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+gpio_dev_t GPIO;
+
+esp_err_t gpio_config(const gpio_config_t *config)                  { return ESP_OK; }
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level)            { return ESP_OK; }
+esp_err_t gpio_pullup_en(gpio_num_t pin)                            { return ESP_OK; }
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type)  { return ESP_OK; }
+esp_err_t gpio_install_isr_service(int flags)                       { return ESP_OK; }
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t handler, void *arg) 
+                                                                    { return ESP_OK; }
+esp_err_t gpio_isr_handler_remove(gpio_num_t pin)                   { return ESP_OK; }
+esp_err_t spi_init(spi_host_t host, spi_config_t *config)           { return ESP_FAIL; }
+esp_err_t spi_deinit(spi_host_t host)                               { return ESP_OK; }
+esp_err_t spi_trans(spi_host_t host, spi_trans_t *trans)            { return ESP_FAIL; }
+
+uint32_t 
+esp_random(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *  
+ * Cycle counter of the perf variant, see host/Makefile. Every read advances
+ * it by 1us, so a measured interval is the number of reads it spans and 
+ * latencies don't depend on the host.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+uint32_t
+HOST_FakeCycles(void)
+{
+    CYCLES += CPU_FREQ_MHZ;
+    return CYCLES;
+}
@@ -0,0 +1,48 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. No HSPI: spi_init() fails. */
+#ifndef _host_spi_h_
+#define _host_spi_h_
+
+#include "driver/gpio.h"
+
+typedef enum { SPI_MASTER_MODE, SPI_SLAVE_MODE }spi_mode_t;
+typedef enum { CSPI_HOST = 0, HSPI_HOST }spi_host_t;
+typedef int spi_clk_div_t;
+
+typedef union {
+    struct { uint32_t read_buffer:1, cpol:1, cpha:1, bit_tx_order:1, bit_rx_order:1, 
+                      byte_tx_order:1, byte_rx_order:1, mosi_en:1, miso_en:1, cs_en:1, reserved:22; };
+    uint32_t val;
+}spi_interface_t;
+
+typedef union {
+    struct { uint32_t read_buffer:1, write_buffer:1, read_status:1, write_status:1, trans_done:1, reserved:27; };
+    uint32_t val;
+}spi_intr_enable_t;
+
+typedef struct {
+    spi_interface_t     interface;
+    spi_intr_enable_t   intr_enable;
+    void                (*event_cb)(int event, void *arg);
+    spi_mode_t          mode;
+    spi_clk_div_t       clk_div;
+}spi_config_t;
+
+typedef struct {
+    uint16_t *cmd;
+    uint32_t *addr;
+    uint32_t *mosi;
+    uint32_t *miso;
+    union {
+        struct { uint32_t cmd:5, addr:7, mosi:10, miso:10; };
+        uint32_t val;
+    }bits;
+}spi_trans_t;
+
+#define SPI_DEFAULT_INTERFACE           0x1C0
+#define SPI_MASTER_DEFAULT_INTR_ENABLE  0x10
+
+esp_err_t spi_init(spi_host_t host, spi_config_t *config);
+esp_err_t spi_deinit(spi_host_t host);
+esp_err_t spi_trans(spi_host_t host, spi_trans_t *trans);
+
+#endif // _host_spi_h_
@@ -0,0 +1,14 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. Register addresses are the
+   fields of the GPIO block in gpio_struct.h. */
+#ifndef _host_eagle_soc_h_
+#define _host_eagle_soc_h_
+
+#include "esp8266/gpio_struct.h"
+
+#define GPIO_STATUS_ADDRESS         (&GPIO.status)
+#define GPIO_STATUS_W1TC_ADDRESS    (&GPIO.status_w1tc)
+
+#define GPIO_REG_READ(addr)         (*(addr))
+#define GPIO_REG_WRITE(addr, val)   (*(addr) = (val))
+
+#endif // _host_eagle_soc_h_
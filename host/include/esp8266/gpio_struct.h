@@ -0,0 +1,23 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. The GPIO registers are plain
+   memory in host_stubs.c: writes stick, nothing drives GPIO.in. */
+#ifndef _host_gpio_struct_h_
+#define _host_gpio_struct_h_
+
+#include <stdint.h>
+
+typedef volatile struct gpio_dev_s {
+    uint32_t    out;
+    uint32_t    out_w1ts;
+    uint32_t    out_w1tc;
+    uint32_t    enable;
+    uint32_t    enable_w1ts;
+    uint32_t    enable_w1tc;
+    uint32_t    in;
+    uint32_t    status;
+    uint32_t    status_w1ts;
+    uint32_t    status_w1tc;
+}gpio_dev_t;
+
+extern gpio_dev_t GPIO;
+
+#endif // _host_gpio_struct_h_
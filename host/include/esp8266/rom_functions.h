@@ -0,0 +1 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. Nothing from ROM is used. */
@@ -0,0 +1,7 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. There is no IRAM. */
+#ifndef _host_esp_attr_h_
+#define _host_esp_attr_h_
+
+#define IRAM_ATTR
+
+#endif // _host_esp_attr_h_
@@ -0,0 +1,18 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. Errors and warnings go to
+   stderr; info and debug only with -DHOST_VERBOSE. */
+#ifndef _host_esp_log_h_
+#define _host_esp_log_h_
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...)     fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...)     fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#ifdef HOST_VERBOSE
+#define ESP_LOGI(tag, fmt, ...)     printf("I %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...)     printf("D %s: " fmt "\n", tag, ##__VA_ARGS__)
+#else
+#define ESP_LOGI(tag, fmt, ...)     do { if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGD(tag, fmt, ...)     do { if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+#endif
+
+#endif // _host_esp_log_h_
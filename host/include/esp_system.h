@@ -0,0 +1,9 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. esp_random() is rand(). */
+#ifndef _host_esp_system_h_
+#define _host_esp_system_h_
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
+
+#endif // _host_esp_system_h_
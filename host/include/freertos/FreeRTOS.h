@@ -0,0 +1,28 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Host build stand-in for the RTOS SDK header, see host/Makefile. Only what 
+ * the driver uses; host_stubs.c implements it for a single task.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _host_freertos_h_
+#define _host_freertos_h_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef int32_t     BaseType_t;
+typedef uint32_t    UBaseType_t;
+typedef uint32_t    TickType_t;
+
+#define pdFALSE                 0
+#define pdTRUE                  1
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
+#define portMAX_DELAY           0xFFFFFFFFU
+#define configTICK_RATE_HZ      100
+#define configMAX_PRIORITIES    15
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((TickType_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define portENTER_CRITICAL()
+#define portEXIT_CRITICAL()
+
+#endif // _host_freertos_h_
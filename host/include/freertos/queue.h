@@ -0,0 +1,15 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. */
+#ifndef _host_queue_h_
+#define _host_queue_h_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct _host_queue_t *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t    xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait);
+BaseType_t    xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait);
+UBaseType_t   uxQueueMessagesWaiting(QueueHandle_t queue);
+void          vQueueDelete(QueueHandle_t queue);
+
+#endif // _host_queue_h_
@@ -0,0 +1,18 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. */
+#ifndef _host_semphr_h_
+#define _host_semphr_h_
+
+#include "freertos/queue.h"
+
+typedef struct _host_semaphore_t *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void);
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t        xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t wait);
+BaseType_t        xSemaphoreGiveRecursive(SemaphoreHandle_t sem);
+void              vSemaphoreDelete(SemaphoreHandle_t sem);
+
+#endif // _host_semphr_h_
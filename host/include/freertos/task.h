@@ -0,0 +1,21 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. There is one task; 
+   xTaskCreate() fails, so async mode is not available on the host. */
+#ifndef _host_task_h_
+#define _host_task_h_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct _host_task_t *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+BaseType_t   xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *arg, 
+                         UBaseType_t priority, TaskHandle_t *task);
+void         vTaskDelete(TaskHandle_t task);
+void         vTaskDelay(TickType_t ticks);
+TickType_t   xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t  uxTaskPriorityGet(TaskHandle_t task);
+void         vTaskSuspendAll(void);
+BaseType_t   xTaskResumeAll(void);
+
+#endif // _host_task_h_
@@ -0,0 +1,21 @@
+/* Host build stand-in, see freertos/FreeRTOS.h. Timers only expire when the
+   host advances the tick count, see HOST_AdvanceTicks(). */
+#ifndef _host_timers_h_
+#define _host_timers_h_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct _host_timer_t *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload, void *id, 
+                           TimerCallbackFunction_t callback);
+BaseType_t    xTimerStart(TimerHandle_t timer, TickType_t wait);
+BaseType_t    xTimerStop(TimerHandle_t timer, TickType_t wait);
+BaseType_t    xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t wait);
+BaseType_t    xTimerDelete(TimerHandle_t timer, TickType_t wait);
+void         *pvTimerGetTimerID(TimerHandle_t timer);
+
+void          HOST_AdvanceTicks(TickType_t ticks);
+
+#endif // _host_timers_h_
@@ -0,0 +1,2 @@
+/* Host build stand-in, the SDK also puts freertos/ on the include path. */
+#include "freertos/task.h"
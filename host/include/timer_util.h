@@ -0,0 +1,50 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Host build stand-in for components/misc/timer_util.h, which reads the 
+ * Xtensa CCOUNT register. CCOUNT is emulated from the monotonic clock at
+ * CPU_FREQ_MHZ, so benchmarks and latency stats keep their units. The perf
+ * variant times with HOST_FakeCycles() instead, see host/Makefile.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _timer_util_h_
+#define _timer_util_h_
+
+#include <stdint.h>
+#include <time.h>
+
+#ifndef CPU_FREQ_MHZ
+#define CPU_FREQ_MHZ    80
+#endif
+
+#define NS_TO_TICKS(ns)   ((((ns) * CPU_FREQ_MHZ) + 999) / 1000)
+
+#define TICKS_IN_100_NS  NS_TO_TICKS(100)
+#define TICKS_IN_250_NS  NS_TO_TICKS(250)
+#define TICKS_IN_500_NS  NS_TO_TICKS(500)
+#define TICKS_IN_300_NS  NS_TO_TICKS(300)
+#define TICKS_IN_600_NS  NS_TO_TICKS(600)
+#define TICKS_IN_750_NS  NS_TO_TICKS(750)
+#define TICKS_IN_900_NS  NS_TO_TICKS(900)
+#define TICKS_IN_1000_NS NS_TO_TICKS(1000)
+#define TICKS_IN_1300_NS NS_TO_TICKS(1300)
+#define TICKS_IN_2000_NS NS_TO_TICKS(2000)
+#define TICKS_IN_3000_NS NS_TO_TICKS(3000)
+#define TICKS_IN_3450_NS NS_TO_TICKS(3450)
+#define TICKS_IN_4000_NS NS_TO_TICKS(4000)
+#define TICKS_IN_4700_NS NS_TO_TICKS(4700)
+#define TICKS_IN_5000_NS NS_TO_TICKS(5000)
+
+static inline uint32_t getCCOUNT(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec) * CPU_FREQ_MHZ / 1000);
+}
+
+uint32_t HOST_FakeCycles(void);
+
+static inline void delay(uint32_t delay_time_in_cpu_ticks)
+{
+    uint32_t start = getCCOUNT();
+    while ((getCCOUNT()-start) < delay_time_in_cpu_ticks);
+}
+
+#endif // _timer_util_h_
@@ -3,3 +3,24 @@
 #
 # (Uses default behaviour of compiling all source files in directory, adding 'include' to include path.)
 
+#
+# Assets: every XBM in bmp/ is compiled by tools/bmp2page.py into page-format
+# tables in this component's build directory. Set BMP_RLE=1 to compress them.
+#
+BMP_ASSETS   := $(wildcard $(COMPONENT_PATH)/bmp/*)
+BMP2PAGE     := $(PROJECT_PATH)/tools/bmp2page.py
+BMP_RLE      ?= 0
+
+COMPONENT_OBJS         := user_main.o bmp_assets.o
+COMPONENT_EXTRA_CLEAN  := bmp_assets.c bmp_assets.h
+CFLAGS                 += -I$(COMPONENT_BUILD_DIR)
+
+bmp_assets.c bmp_assets.h: $(BMP_ASSETS) $(BMP2PAGE)
+	$(summary) BMP2PAGE $(patsubst $(PWD)/%,%,$(COMPONENT_PATH))/bmp
+	python3 $(BMP2PAGE) --out-dir $(COMPONENT_BUILD_DIR) $(if $(filter 1,$(BMP_RLE)),--rle) $(BMP_ASSETS)
+
+bmp_assets.o: bmp_assets.c
+	$(summary) CC $(patsubst $(PWD)/%,%,$(COMPONENT_BUILD_DIR))/$<
+	$(CC) $(CFLAGS) $(CPPFLAGS) $(addprefix -I ,$(COMPONENT_INCLUDES)) $(addprefix -I ,$(COMPONENT_EXTRA_INCLUDES)) -c $< -o $@
+
+user_main.o: bmp_assets.h
@@ -1,26 +1,45 @@
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "result_codes.h"
+#include "timer_util.h"
+#include "i2c.h"
+#include "perf_stats.h"
 #include "ssd1306.h"
+#include "ssd1306_transport.h"
+#include "ssd1306_font.h"
+#include "bmp_assets.h"
 
 #define WIFI_NO_WIFI        0
 #define WIFI_POOR_WIFI      1
 #define WIFI_GOOD_WIFI      2
 #define WIFI_EXCELLENT_WIFI 3
 
-const uint8_t wifi_status[4][16] = {
-    {0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},     // no wifi
-    {0x00, 0x00, 0x02, 0x04, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},     // poor wifi
-    {0x00, 0x08, 0x12, 0x14, 0x14, 0x12, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},     // good wifi
-    {0x20, 0x48, 0x52, 0x54, 0x54, 0x52, 0x48, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}      // excellent wifi
+static const BMP_ASSET *const wifi_status[4] = {
+    &BMP_WIFI_NO_WIFI,
+    &BMP_WIFI_POOR,
+    &BMP_WIFI_GOOD,
+    &BMP_WIFI_EXCELLENT
 };
 
+/* Asset bits ready to blit: uncompressed assets are used in place. */
+static const uint8_t *
+assetBits(const BMP_ASSET *asset, uint8_t *scratch, size_t length)
+{
+    if (!asset->rle) {
+        return asset->bits;
+    }
+
+    return (BMP_Decode(asset, scratch, length) > 0) ? scratch : NULL;
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  *  Program: ssd1306 
  *  Date   : 10/18/2018
@@ -53,6 +72,10 @@ const char *getResultString(RESULT result)
             return "Failed to allocate memory.";
         case FAILED_TO_CONFIGURE_I2C_PINS:
             return "Failed to configure I2C pins.";
+        case FAILED_TO_CONFIGURE_SPI:
+            return "Failed to configure SPI.";
+        case FAILED_TO_CREATE_TASK:
+            return "Failed to create task.";
         case FAILED_TO_INSTALL_ISR_FUNCTION:
             return "Failed to install ISR.";
         case FAILED_TO_INSTALL_ISR_SERVICE:
@@ -63,6 +86,8 @@ const char *getResultString(RESULT result)
             return "Failed to set Pin level.";
         case FAILED_TO_SEND_SLAVE_ADDRESS:
             return "Slave Address not ACK'd by slave device.";
+        case FAILED_WRITE:
+            return "Failed to write to slave device.";
         case FAILED_WRITE_RECEIVED_NACK:
             return "Received NACK from slave device.";
         case INVALID_ARGUMENT:
@@ -88,10 +113,65 @@ const char *getResultString(RESULT result)
     }
 }
 
+static void
+onFrameSent(void *arg, RESULT result)
+{
+    if (result != OK) {
+        ESP_LOGE("MAIN", "Async frame FAILED! Error: %s", getResultString(result));
+    }
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+static void
+onRampDone(void *arg, RESULT result)
+{
+    if (result != OK) {
+        ESP_LOGE("MAIN", "Contrast ramp FAILED! Error: %s", getResultString(result));
+    }
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
 void 
 app_main(void)
 {
     void *ssd1306 = NULL;
+
+    #if PERF_STATS_ENABLED
+    PERF_ResetStats();
+    PERF_StartLogging(10000);
+    #endif
+
+    #ifdef DEBUG
+    ESP_LOGD("MAIN", "\n---Test: Benchmark I2C bit kernels---");
+    void *i2c = NULL;
+    if (I2C_Initialize(SLAVE_ADDRESS, SCL_PIN, SDA_PIN, I2C_ACK_NONE, I2C_SPEED_MAX, &i2c) == OK) {
+        I2C_BenchmarkKernels(i2c, 10000);
+        I2C_FreeContext(&i2c);
+    }
+
+    ESP_LOGD("MAIN", "\n---Test: Fill display through the mock transport---");
+    void *mock = NULL;
+    void *mockDisplay = NULL;
+    if ((SSD1306_MockOpen(&mock) == OK) &&
+        (SSD1306_InitializeTransport(&SSD1306_MOCK_TRANSPORT, mock, DEFAULT_CONTRAST, &mockDisplay) == OK)) {
+        SSD1306_MockResetStats(mock);
+        SSD1306_FillDisplay(mockDisplay, 0xA5);
+        const uint8_t *gddram = SSD1306_MockGetGDDRAM(mock);
+        uint32_t wrong = 0;
+        for (uint32_t x = 0; x < SSD1306_WIDTH*SSD1306_HEIGHT/8; x++) {
+            wrong += (gddram[x] != 0xA5);
+        }
+        SSD1306_MOCK_STATS stats;
+        SSD1306_MockGetStats(mock, &stats);
+        ESP_LOGD("MAIN", "Mock: %u bad bytes, %u command xmits (%u bytes), %u data xmits (%u bytes).", 
+                 wrong, stats.commandXmits, stats.commandBytes, stats.dataXmits, stats.dataBytes);
+        SSD1306_FreeContext(&mockDisplay);
+    }
+
+    ESP_LOGD("MAIN", "\n---Test: Benchmark row-major to page-format transpose---");
+    SSD1306_BenchmarkTranspose(100);
+    #endif
+
     ESP_LOGD("MAIN", "Calling SSD1306_initialize(0x%x, SCL:%d, SDA:%d, CONTRAST:0x%x).", SLAVE_ADDRESS, SCL_PIN, SDA_PIN, DEFAULT_CONTRAST);
     RESULT result = SSD1306_Initialize(SLAVE_ADDRESS, SCL_PIN, SDA_PIN, DEFAULT_CONTRAST, &ssd1306);
     if (result != OK) {
@@ -115,6 +195,18 @@ app_main(void)
     ESP_LOGD("MAIN", "---Test: Clear the display---"); 
     SSD1306_ClearDisplay(ssd1306);
     vTaskDelay(25);
+
+    ESP_LOGD("MAIN", "\n---Test: Second device on the display's bus---");
+    void *probe = NULL;
+    if (I2C_Initialize(SLAVE_ADDRESS+1, SCL_PIN, SDA_PIN, I2C_ACK_POLLED, I2C_SPEED_FAST, &probe) == OK) {
+        for (uint8_t x=0; x<4; x++) {
+            RESULT present = I2C_StartXmit(probe);          // address byte only, NACK'd if nothing at 0x3D
+            I2C_StopXmit(probe);
+            SSD1306_FillDisplay(ssd1306, (x & 0x1) ? 0x00 : 0xFF);
+            ESP_LOGD("MAIN", "Slave 0x%x %s, display still driven.", SLAVE_ADDRESS+1, (present == OK) ? "ACK'd" : "absent");
+        }
+        I2C_FreeContext(&probe);
+    }
    
     for (uint8_t x=0; x<10; x++) {
         uint8_t fill = esp_random() % 256; 
@@ -123,30 +215,279 @@ app_main(void)
         vTaskDelay(25); 
     }
 
+    ESP_LOGD("MAIN", "\n---Test: Time full screen fill---");
+    uint32_t start = getCCOUNT();
     SSD1306_FillDisplay(ssd1306, 0xFF);
+    uint32_t ticks = getCCOUNT() - start;
+    ESP_LOGD("MAIN", "FillDisplay took %u cpu ticks (%u ticks/byte).", ticks, ticks/(SSD1306_WIDTH*SSD1306_HEIGHT/8));
 
-    ESP_LOGD("MAIN", "\n---Test: Decrease contrast---");
-    for (uint8_t x=255; x>0; x-=5) {
-        SSD1306_SetContrast(ssd1306, x);
-        vTaskDelay(3);
+    ESP_LOGD("MAIN", "\n---Test: Time full screen fill per bus-speed profile---");
+    static const char *profiles[] = { "STANDARD", "FAST", "FAST_PLUS", "MAX" };
+    for (int x=I2C_SPEED_STANDARD; x<=I2C_SPEED_MAX; x++) {
+        SSD1306_SetBusSpeed(ssd1306, (I2C_BUS_SPEED)x);
+        start = getCCOUNT();
+        SSD1306_FillDisplay(ssd1306, (x & 0x1) ? 0x00 : 0xFF);
+        ticks = getCCOUNT() - start;
+        ESP_LOGD("MAIN", "%-9s: frame in %u us.", profiles[x], ticks/CPU_FREQ_MHZ);
     }
-    vTaskDelay(25);
+    SSD1306_FillDisplay(ssd1306, 0xFF);
 
-    ESP_LOGD("MAIN", "\n---Test: Increase contrast---");
-    for (uint8_t x=0; x<255; x+=5) {
-        SSD1306_SetContrast(ssd1306, x);
-        vTaskDelay(3);
+    ESP_LOGD("MAIN", "\n---Test: Ramp contrast down and up from a timer---");
+    SemaphoreHandle_t rampDone = xSemaphoreCreateBinary();
+    if (rampDone != NULL) {
+        SSD1306_StartContrastRamp(ssd1306, 0, 1500, onRampDone, rampDone);
+        xSemaphoreTake(rampDone, portMAX_DELAY);
+        vTaskDelay(25);
+        SSD1306_StartContrastRamp(ssd1306, 255, 1500, onRampDone, rampDone);
+        xSemaphoreTake(rampDone, portMAX_DELAY);
+        vSemaphoreDelete(rampDone);
     }
 
+    ESP_LOGD("MAIN", "\n---Test: Effects without redraw---");
+    SSD1306_FillDisplay(ssd1306, 0x55);
+    SSD1306_SetInverted(ssd1306, true);
+    vTaskDelay(50);
+    SSD1306_SetInverted(ssd1306, false);
+    for (uint8_t x=0; x<3; x++) {                   // alert flash
+        SSD1306_SetEntireDisplayOn(ssd1306, true);
+        vTaskDelay(15);
+        SSD1306_SetEntireDisplayOn(ssd1306, false);
+        vTaskDelay(15);
+    }
+    SSD1306_SetZoom(ssd1306, true);
+    vTaskDelay(50);
+    SSD1306_SetZoom(ssd1306, false);
+    SSD1306_SetFade(ssd1306, SSD1306_FADE_BLINK, 16);
+    vTaskDelay(300);
+    SSD1306_SetFade(ssd1306, SSD1306_FADE_DISABLED, 0);
+    SSD1306_SetContrast(ssd1306, DEFAULT_CONTRAST);
+
     SSD1306_ClearDisplay(ssd1306);
     vTaskDelay(25);
 
     ESP_LOGD("MAIN", "\n---Test: Write PAGES to screen");
+    PAGE *icons = (PAGE *)calloc(8, sizeof(PAGE));
+    if (icons != NULL) {
+        for (int x=0; x<4; x++) {
+            BMP_Decode(wifi_status[x], icons[2*x].page, sizeof(icons[2*x].page));
+            SSD1306_UpdatePage(ssd1306, 2*x, &icons[2*x]);
+            vTaskDelay(5);
+        }
+
+        ESP_LOGD("MAIN", "\n---Test: Write all PAGES in one transaction---");
+        SSD1306_ClearDisplay(ssd1306);
+        start = getCCOUNT();
+        SSD1306_UpdatePages(ssd1306, 0, 8, icons);
+        ESP_LOGD("MAIN", "UpdatePages took %u us.", (getCCOUNT() - start)/CPU_FREQ_MHZ);
+        free(icons);
+    }
+
+    vTaskDelay(50);
+    SSD1306_ClearDisplay(ssd1306);
+
+    ESP_LOGD("MAIN", "\n---Test: Blit icons at arbitrary positions---");
     for (int x=0; x<4; x++) {
-        SSD1306_UpdatePage(ssd1306, 2*x, (const PAGE *)&wifi_status[x]);
-        vTaskDelay(5);
+        uint8_t scratch[8];
+        const uint8_t *icon = assetBits(wifi_status[x], scratch, sizeof(scratch));
+        SSD1306_Blit(ssd1306, (POINT){3 + 13*x, 5 + 29*x}, wifi_status[x]->width, wifi_status[x]->height, 
+                     icon, NULL, SSD1306_BLIT_COPY);
+    }
+    vTaskDelay(50);
+    if (SSD1306_EnableFramebuffer(ssd1306, true) == OK) {
+        SSD1306_FillDisplay(ssd1306, 0xFF);
+        for (int x=0; x<4; x++) {
+            // icon as its own mask: XOR cuts it out of the lit background
+            uint8_t scratch[8];
+            const uint8_t *icon = assetBits(wifi_status[x], scratch, sizeof(scratch));
+            SSD1306_Blit(ssd1306, (POINT){3 + 13*x, 5 + 29*x}, wifi_status[x]->width, wifi_status[x]->height, 
+                         icon, icon, SSD1306_BLIT_XOR);
+        }
+        SSD1306_Flush(ssd1306);
+        vTaskDelay(50);
+
+        ESP_LOGD("MAIN", "\n---Test: Screenshot and send it back as a row-major frame---");
+        uint8_t *shot = (uint8_t *)malloc(SSD1306_ROW_STRIDE(SSD1306_WIDTH) * SSD1306_HEIGHT);
+        PAGE *frame = (PAGE *)malloc(8 * sizeof(PAGE));
+        if ((shot != NULL) && (frame != NULL) && (SSD1306_Screenshot(ssd1306, shot) == OK)) {
+            SSD1306_EnableFramebuffer(ssd1306, false);
+            SSD1306_ClearDisplay(ssd1306);
+            start = getCCOUNT();
+            SSD1306_RowsToPages(shot, SSD1306_WIDTH, SSD1306_HEIGHT, (uint8_t *)frame);
+            SSD1306_UpdatePages(ssd1306, 0, 8, frame);
+            ESP_LOGD("MAIN", "Row-major frame converted and sent in %u us.", (getCCOUNT() - start)/CPU_FREQ_MHZ);
+            vTaskDelay(50);
+        }
+        free(shot);
+        free(frame);
+        SSD1306_EnableFramebuffer(ssd1306, false);
+    }
+    SSD1306_ClearDisplay(ssd1306);
+
+    ESP_LOGD("MAIN", "\n---Test: Draw pixels while transmit task flushes frames---");
+    SemaphoreHandle_t frameSent = xSemaphoreCreateBinary();
+    if ((frameSent != NULL) && (SSD1306_StartAsync(ssd1306, uxTaskPriorityGet(NULL)+1) == OK)) {
+        for (int frame=0; frame<50; frame++) {
+            for (int x=0; x<20; x++) {
+                SSD1306_DrawPixel(ssd1306, esp_random() % SSD1306_HEIGHT, esp_random() % SSD1306_WIDTH);
+            }
+            SSD1306_FlushAsync(ssd1306, onFrameSent, frameSent);
+            xSemaphoreTake(frameSent, portMAX_DELAY);
+        }
+
+        SSD1306_ASYNC_STATS stats;
+        SSD1306_GetAsyncStats(ssd1306, &stats);
+        ESP_LOGD("MAIN", "Async: %u requests, %u merged, %u sent, %u failed, max depth %u, latency last %u us max %u us.",
+                    stats.requests, stats.merged, stats.completed, stats.failed, 
+                    stats.maxQueueDepth, stats.lastLatencyUs, stats.maxLatencyUs);
+
+        SSD1306_StopAsync(ssd1306);
+        SSD1306_EnableFramebuffer(ssd1306, false);
+    }
+    if (frameSent != NULL) {
+        vSemaphoreDelete(frameSent);
+    }
+
+    vTaskDelay(50);
+    SSD1306_ClearDisplay(ssd1306);
+
+    ESP_LOGD("MAIN", "\n---Test: Rectangles and circles---");
+    POINT corner1 = {4, 4};
+    POINT corner2 = {59, 123};
+    POINT center  = {32, 64};
+    SSD1306_DrawRectangle(ssd1306, corner1, corner2, false, SSD1306_DRAW_SET);
+    SSD1306_DrawCircle(ssd1306, center, 20, false, SSD1306_DRAW_SET);
+    vTaskDelay(50);
+    if (SSD1306_EnableFramebuffer(ssd1306, true) == OK) {
+        uint32_t start = getCCOUNT();
+        SSD1306_DrawRectangle(ssd1306, corner1, corner2, false, SSD1306_DRAW_SET);     // shadow starts blank
+        SSD1306_DrawCircle(ssd1306, center, 20, false, SSD1306_DRAW_SET);
+        corner1 = (POINT){16, 32};
+        corner2 = (POINT){47, 95};
+        SSD1306_DrawRectangle(ssd1306, corner1, corner2, true, SSD1306_DRAW_INVERT);
+        SSD1306_DrawCircle(ssd1306, center, 12, true, SSD1306_DRAW_INVERT);
+        SSD1306_Flush(ssd1306);
+        ESP_LOGD("MAIN", "Filled shapes drawn and flushed in %u us.", (getCCOUNT() - start)/CPU_FREQ_MHZ);
+        vTaskDelay(50);
+        SSD1306_EnableFramebuffer(ssd1306, false);
+    }
+    SSD1306_ClearDisplay(ssd1306);
+
+    ESP_LOGD("MAIN", "\n---Test: Redraw a 21x8 status screen---");
+    if (SSD1306_EnableFramebuffer(ssd1306, true) == OK) {
+        char line[22];
+        uint32_t start = getCCOUNT();
+        for (int frame=0; frame<30; frame++) {
+            SSD1306_FillDisplay(ssd1306, 0x00);
+            for (int x=0; x<8; x++) {
+                snprintf(line, sizeof(line), "Line %d frame %-4d %c", x, frame, "|/-\\"[frame & 3]);
+                SSD1306_DrawText(ssd1306, (POINT){8*x, 0}, &SSD1306_FONT_5X7, line, SSD1306_DRAW_SET);
+            }
+            SSD1306_Flush(ssd1306);
+        }
+        uint32_t us = (getCCOUNT() - start)/CPU_FREQ_MHZ;
+        ESP_LOGD("MAIN", "30 status frames in %u us (%u fps).", us, (us > 0) ? 30000000/us : 0);
+
+        SSD1306_FillDisplay(ssd1306, 0x00);
+        const char *caption = "Proportional text";
+        uint8_t col = (SSD1306_WIDTH - SSD1306_MeasureText(&SSD1306_FONT_5X7_PROP, caption)) / 2;
+        SSD1306_DrawText(ssd1306, (POINT){29, col}, &SSD1306_FONT_5X7_PROP, caption, SSD1306_DRAW_SET);
+        SSD1306_Flush(ssd1306);
+        vTaskDelay(50);
+        SSD1306_EnableFramebuffer(ssd1306, false);
     }
+    SSD1306_ClearDisplay(ssd1306);
+
+    ESP_LOGD("MAIN", "\n---Test: Scroll a ticker and a diagonal in hardware---");
+    if (SSD1306_EnableFramebuffer(ssd1306, true) == OK) {
+        SSD1306_DrawText(ssd1306, (POINT){0, 0}, &SSD1306_FONT_5X7, "Scrolling, no traffic", SSD1306_DRAW_SET);
+        SSD1306_DrawCircle(ssd1306, (POINT){40, 64}, 16, true, SSD1306_DRAW_SET);
+        SSD1306_Flush(ssd1306);
+
+        SSD1306_SCROLL ticker = { SSD1306_SCROLL_LEFT, SSD1306_SCROLL_2_FRAMES, 0, 0, 0, 0, 0 };
+        SSD1306_StartScroll(ssd1306, &ticker);
+        vTaskDelay(300);
+
+        // Text row stays, everything below drifts up and to the right.
+        SSD1306_SCROLL diagonal = { SSD1306_SCROLL_RIGHT, SSD1306_SCROLL_5_FRAMES, 1, 7, 1, 8, 0 };
+        SSD1306_StartScroll(ssd1306, &diagonal);
+        vTaskDelay(300);
+
+        SSD1306_StopScroll(ssd1306);        // pages 1-7 are rewritten from the framebuffer
+        vTaskDelay(50);
+        SSD1306_EnableFramebuffer(ssd1306, false);
+    }
+    SSD1306_ClearDisplay(ssd1306);
+
+    ESP_LOGD("MAIN", "\n---Test: Stream log lines through the console---");
+    if (SSD1306_ConsoleOpen(ssd1306, &SSD1306_FONT_5X7) == OK) {
+        char line[22];
+        uint32_t start = getCCOUNT();
+        for (int x=0; x<40; x++) {
+            snprintf(line, sizeof(line), "log %2d: tick %u\n", x, xTaskGetTickCount());
+            SSD1306_ConsoleWrite(ssd1306, line);
+        }
+        uint32_t us = (getCCOUNT() - start)/CPU_FREQ_MHZ;
+        ESP_LOGD("MAIN", "40 console lines in %u us (%u us per line).", us, us/40);
+        vTaskDelay(100);
+        SSD1306_ConsoleClose(ssd1306);
+    }
+    SSD1306_ClearDisplay(ssd1306);
+
+    ESP_LOGD("MAIN", "\n---Test: Flip and rotate in the controller---");
+    // The segment remap only applies to new writes: rotate a clear screen.
+    SSD1306_SetRotation(ssd1306, SSD1306_ROTATE_180, false, false);
+    SSD1306_DrawText(ssd1306, (POINT){0, 0}, &SSD1306_FONT_5X7, "Upside down", SSD1306_DRAW_SET);
+    vTaskDelay(100);
+
+    uint8_t *portrait = (uint8_t *)malloc(SSD1306_PORTRAIT_HEIGHT * SSD1306_ROW_STRIDE(SSD1306_PORTRAIT_WIDTH));
+    if ((portrait != NULL) && (SSD1306_SetRotation(ssd1306, SSD1306_ROTATE_90, false, false) == OK)) {
+        const uint8_t stride = SSD1306_ROW_STRIDE(SSD1306_PORTRAIT_WIDTH);
+        uint32_t start = getCCOUNT();
+        for (int frame=0; frame<SSD1306_PORTRAIT_HEIGHT; frame++) {
+            // A bar falling down the tall axis.
+            for (int row=0; row<SSD1306_PORTRAIT_HEIGHT; row++) {
+                memset(&portrait[row * stride], (abs(row - frame) < 4) ? 0xFF : 0x81, stride);
+            }
+            SSD1306_UpdatePortrait(ssd1306, portrait);
+        }
+        uint32_t us = (getCCOUNT() - start)/CPU_FREQ_MHZ;
+        ESP_LOGD("MAIN", "%d portrait frames in %u us.", SSD1306_PORTRAIT_HEIGHT, us);
 
+        // Shapes take portrait coordinates too.
+        SSD1306_ClearDisplay(ssd1306);
+        SSD1306_DrawRectangle(ssd1306, (POINT){0, 0}, (POINT){SSD1306_PORTRAIT_HEIGHT-1, SSD1306_PORTRAIT_WIDTH-1}, 
+                              false, SSD1306_DRAW_SET);
+        SSD1306_DrawLine(ssd1306, (POINT){0, 0}, (POINT){SSD1306_PORTRAIT_HEIGHT-1, SSD1306_PORTRAIT_WIDTH-1});
+        vTaskDelay(100);
+    }
+    free(portrait);
+    SSD1306_SetRotation(ssd1306, SSD1306_ROTATE_0, false, false);
+    SSD1306_ClearDisplay(ssd1306);
+
+    ESP_LOGD("MAIN", "\n---Test: Pixels left to right reuse the address window---");
+    SSD1306_WINDOW_STATS before, after;
+    SSD1306_GetWindowStats(ssd1306, &before);
+    start = getCCOUNT();
+    for (uint8_t col=0; col<SSD1306_WIDTH; col++) {
+        SSD1306_DrawPixel(ssd1306, SSD1306_HEIGHT/2, col);
+    }
+    ticks = getCCOUNT() - start;
+    SSD1306_GetWindowStats(ssd1306, &after);
+    ESP_LOGD("MAIN", "%u pixels in %u us: %u windows skipped, %u shrunk, %u command bytes saved.", SSD1306_WIDTH, 
+             ticks/CPU_FREQ_MHZ, after.skipped - before.skipped, after.shrunk - before.shrunk, 
+             after.bytesSaved - before.bytesSaved);
+
+    ESP_LOGD("MAIN", "\n---Test: Pixels along one page share a transaction with their window---");
+    SSD1306_GetWindowStats(ssd1306, &before);
+    start = getCCOUNT();
+    for (uint8_t col=0; col<SSD1306_WIDTH; col+=2) {
+        SSD1306_DrawPixel(ssd1306, SSD1306_HEIGHT/2 + 1, col);     // column moves on, page stays
+    }
+    ticks = getCCOUNT() - start;
+    SSD1306_GetWindowStats(ssd1306, &after);
+    ESP_LOGD("MAIN", "%u pixels in %u us: %u windows sent with their data, %u in page mode, %u mode switches.", 
+             SSD1306_WIDTH/2, ticks/CPU_FREQ_MHZ, after.mixed - before.mixed, after.pageMode - before.pageMode,
+             after.modeSwitches - before.modeSwitches);
     vTaskDelay(50);
     SSD1306_ClearDisplay(ssd1306);
 
@@ -164,15 +505,19 @@ app_main(void)
         SSD1306_ClearDisplay(ssd1306);
 
         ESP_LOGD("MAIN", "\n---Test: Draw Random lines---");
+        uint32_t lineUs = 0;
         for (int x=0; x<1000;x++) {
             POINT p1, p2;
             p1.row = esp_random() % SSD1306_HEIGHT;
             p1.col = esp_random() % SSD1306_WIDTH;
             p2.row = esp_random() % SSD1306_HEIGHT;
             p2.col = esp_random() % SSD1306_WIDTH;
+            uint32_t lineStart = getCCOUNT();
             SSD1306_DrawLine(ssd1306, p1, p2);
+            lineUs += (getCCOUNT() - lineStart)/CPU_FREQ_MHZ;
             vTaskDelay(1);
         }
+        ESP_LOGD("MAIN", "1000 lines took %u us, excluding delays.", lineUs);
 
         vTaskDelay(50);
         SSD1306_ClearDisplay(ssd1306);
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+# * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+# The MIT License (MIT)
+#
+# Copyright (c) 2019 by Hector Cura Jr.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# Description:
+#  Host-side asset compiler. Converts XBM bitmaps (row-major, LSB is the
+#  leftmost pixel) into SSD1306 page format (column-major, LSB is the top
+#  row, page-major) and writes bmp_assets.c/.h with one BMP_ASSET per file,
+#  named after the file: bmp/wifi-good becomes BMP_WIFI_GOOD. The symbol
+#  names inside the XBM are ignored, so they need not be valid C.
+#
+#  With --rle, an asset is stored PackBits-compressed when that is smaller;
+#  BMP_Decode() expands it. Uncompressed assets are passed straight to
+#  SSD1306_Blit(). Both read the tables with aligned 32-bit loads, so like
+#  the fonts they follow SSD1306_FONT_STORAGE into flash; expand an asset
+#  with BMP_Decode() before handing it to SSD1306_UpdatePages().
+# * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+import argparse
+import os
+import re
+import sys
+
+XBM_DIMENSION = re.compile(r'#define\s+\S+_(width|height)\s+(\d+)')
+XBM_BITS      = re.compile(r'\{([^}]*)\}', re.S)
+
+
+def parse_xbm(path):
+    with open(path) as f:
+        text = f.read()
+
+    dims = dict((k, int(v)) for k, v in XBM_DIMENSION.findall(text))
+    match = XBM_BITS.search(text)
+    if 'width' not in dims or 'height' not in dims or match is None:
+        raise ValueError('%s: not an XBM bitmap' % path)
+
+    data = [int(tok, 0) for tok in match.group(1).replace(',', ' ').split()]
+    stride = (dims['width'] + 7) // 8
+    if len(data) < stride * dims['height']:
+        raise ValueError('%s: expected %d bytes, found %d' % (path, stride * dims['height'], len(data)))
+
+    return dims['width'], dims['height'], data, stride
+
+
+def to_pages(width, height, data, stride):
+    """Rows of XBM bytes -> pages of column bytes."""
+    pages = (height + 7) // 8
+    out = bytearray(pages * width)
+    for row in range(height):
+        for col in range(width):
+            if data[row * stride + col // 8] & (1 << (col % 8)):
+                out[(row // 8) * width + col] |= 1 << (row % 8)
+    return bytes(out)
+
+
+def packbits(data):
+    """0-127: copy n+1 literal bytes; 128-255: repeat the next byte n-125 times."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 130:
+            run += 1
+        if run >= 3:
+            out += bytes([run + 125, data[i]])
+            i += run
+            continue
+
+        start = i
+        while i < len(data) and i - start < 128:
+            if i + 2 < len(data) and data[i] == data[i + 1] == data[i + 2]:
+                break
+            i += 1
+        out += bytes([i - start - 1]) + data[start:i]
+    return bytes(out)
+
+
+def c_name(path):
+    return 'BMP_' + re.sub(r'[^0-9A-Za-z]', '_', os.path.basename(path)).upper()
+
+
+def c_bytes(data, indent='    '):
+    lines = []
+    for i in range(0, len(data), 12):
+        lines.append(indent + ', '.join('0x%02x' % b for b in data[i:i + 12]) + ',')
+    return '\n'.join(lines)
+
+
+HEADER = '''/* Generated by tools/bmp2page.py from main/bmp, do not edit. */
+#ifndef _bmp_assets_h__
+#define _bmp_assets_h__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct _BMP_ASSET {
+    uint8_t         width;
+    uint8_t         height;
+    bool            rle;        // bits is PackBits, expand with BMP_Decode().
+    uint16_t        size;       // bytes in bits.
+    const uint8_t   *bits;      // (height+7)/8 pages of width bytes, LSB on top.
+}BMP_ASSET;
+
+size_t BMP_Decode(const BMP_ASSET *asset, uint8_t *out, size_t length);
+
+%s
+#endif // _bmp_assets_h__
+'''
+
+SOURCE = '''/* Generated by tools/bmp2page.py from main/bmp, do not edit. */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+#include "result_codes.h"
+#include "i2c.h"
+#include "ssd1306.h"
+#include "ssd1306_font.h"
+#include "bmp_assets.h"
+
+/* Read with SSD1306_FontReadByte(), so the tables may share the fonts' 
+ * storage, flash included. */
+#ifndef BMP_STORAGE
+#define BMP_STORAGE     SSD1306_FONT_STORAGE
+#endif
+
+%s
+/* Expands an asset into out, which needs ((height+7)/8)*width bytes. 
+ * Returns the bytes written, 0 if out is too small. */
+size_t
+BMP_Decode(const BMP_ASSET *asset, uint8_t *out, size_t length)
+{
+    size_t need = ((asset->height + 7) / 8) * asset->width;
+    if (length < need) {
+        return 0;
+    }
+
+    if (!asset->rle) {
+        for (size_t o = 0; o < need; o++) {
+            out[o] = SSD1306_FontReadByte(&asset->bits[o]);
+        }
+        return need;
+    }
+
+    size_t o = 0;
+    for (size_t i = 0; (i < asset->size) && (o < need); ) {
+        uint8_t control = SSD1306_FontReadByte(&asset->bits[i++]);
+        if (control < 128) {
+            for (int n = control + 1; (n > 0) && (o < need); n--) {
+                out[o++] = SSD1306_FontReadByte(&asset->bits[i++]);
+            }
+        } else {
+            uint8_t run = SSD1306_FontReadByte(&asset->bits[i++]);
+            for (int n = control - 125; (n > 0) && (o < need); n--) {
+                out[o++] = run;
+            }
+        }
+    }
+
+    return o;
+}
+'''
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description='Compile XBM assets into SSD1306 page-format tables.')
+    parser.add_argument('--out-dir', required=True, help='where bmp_assets.c/.h are written')
+    parser.add_argument('--rle', action='store_true', help='PackBits-compress assets when smaller')
+    parser.add_argument('inputs', nargs='+')
+    args = parser.parse_args(argv)
+
+    decls, defs = [], []
+    for path in sorted(args.inputs):
+        if os.path.isdir(path):
+            continue
+        name = c_name(path)
+        width, height, data, stride = parse_xbm(path)
+        if width > 128 or height > 64:
+            raise ValueError('%s: %dx%d is larger than the display' % (path, width, height))
+
+        bits = to_pages(width, height, data, stride)
+        rle = False
+        if args.rle:
+            packed = packbits(bits)
+            if len(packed) < len(bits):
+                bits, rle = packed, True
+
+        decls.append('#define %s_WIDTH %d\n#define %s_HEIGHT %d\nextern const BMP_ASSET %s;\n'
+                     % (name, width, name, height, name))
+        defs.append('static const uint8_t %s_BITS[] BMP_STORAGE = {\n%s\n};\n\n'
+                    'const BMP_ASSET %s = { %d, %d, %s, %d, %s_BITS };\n'
+                    % (name, c_bytes(bits), name, width, height, 'true' if rle else 'false', len(bits), name))
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    outputs = {
+        'bmp_assets.h': HEADER % '\n'.join(decls),
+        'bmp_assets.c': SOURCE % '\n'.join(defs),
+    }
+    for filename, text in outputs.items():
+        path = os.path.join(args.out_dir, filename)
+        # leave unchanged files alone so make does not rebuild their users
+        if os.path.exists(path):
+            with open(path) as f:
+                if f.read() == text:
+                    continue
+        with open(path, 'w') as f:
+            f.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))